@@ -668,6 +668,8 @@ struct Example:
         //float   PinArrowWidth;
         ImGui::DragFloat("Group Rounding", &editorStyle.GroupRounding, 0.1f, 0.0f, 40.0f);
         ImGui::DragFloat("Group Border Width", &editorStyle.GroupBorderWidth, 0.1f, 0.0f, 15.0f);
+        ImGui::DragFloat("Reduced Detail Zoom", &editorStyle.ReducedDetailZoom, 0.01f, 0.0f, 1.0f);
+        ImGui::DragFloat("Minimal Detail Zoom", &editorStyle.MinimalDetailZoom, 0.01f, 0.0f, 1.0f);
 
         ImGui::Separator();
 
@@ -1,9 +1,14 @@
 # define IMGUI_DEFINE_MATH_OPERATORS
 # include "drawing.h"
 # include <imgui_internal.h>
+# include <algorithm>
+# include <vector>
 
-void ax::Drawing::DrawIcon(ImDrawList* drawList, const ImVec2& a, const ImVec2& b, IconType type, bool filled, ImU32 color, ImU32 innerColor)
+static void TessellateIcon(ImDrawList* drawList, const ImVec2& a, const ImVec2& b, ax::Drawing::IconType type, bool filled, ImU32 color, ImU32 innerColor)
 {
+    using ax::Drawing::IconType;
+
+
           auto rect           = ImRect(a, b);
           auto rect_x         = rect.Min.x;
           auto rect_y         = rect.Min.y;
@@ -250,3 +255,129 @@ void ax::Drawing::DrawIcon(ImDrawList* drawList, const ImVec2& a, const ImVec2&
         }
     }
 }
+
+namespace {
+
+// Icon geometry does not change as long as size, sub-pixel offset and
+// draw list setup stays the same. It is tessellated once with placeholder
+// colors and later stamped by translating vertices and substituting colors.
+struct IconTemplate
+{
+    ax::Drawing::IconType   Type;
+    bool                    Filled;
+    bool                    HasInner;
+    ImVec2                  Size;
+    ImVec2                  Offset; // fractional part of position, icons snap to pixels
+    float                   FringeScale;
+    ImDrawListFlags         Flags;
+    ImVec2                  TexUvWhitePixel;
+
+    std::vector<ImDrawVert> Vertices; // relative to icon position, see c_InnerRole
+    std::vector<ImDrawIdx>  Indices;
+
+    bool Matches(const IconTemplate& other) const
+    {
+        return Type == other.Type
+            && Filled == other.Filled
+            && HasInner == other.HasInner
+            && Size.x == other.Size.x && Size.y == other.Size.y
+            && Offset.x == other.Offset.x && Offset.y == other.Offset.y
+            && FringeScale == other.FringeScale
+            && Flags == other.Flags
+            && TexUvWhitePixel.x == other.TexUvWhitePixel.x && TexUvWhitePixel.y == other.TexUvWhitePixel.y;
+    }
+};
+
+const ImU32 c_OuterRole        = IM_COL32(255, 0, 0, 255);
+const ImU32 c_InnerRole        = IM_COL32(0, 255, 0, 255);
+const int   c_MaxIconTemplates = 64;
+
+std::vector<IconTemplate> s_IconTemplates;
+
+ImU32 StampColor(ImU32 role, ImU32 color, ImU32 innerColor)
+{
+    const auto source = (role & IM_COL32(0, 255, 0, 0)) ? innerColor : color;
+    const auto alpha  = ((source >> IM_COL32_A_SHIFT) & 0xFF) * ((role >> IM_COL32_A_SHIFT) & 0xFF) / 255;
+
+    return (source & ~IM_COL32_A_MASK) | (alpha << IM_COL32_A_SHIFT);
+}
+
+} // namespace
+
+void ax::Drawing::DrawIcon(ImDrawList* drawList, const ImVec2& a, const ImVec2& b, IconType type, bool filled, ImU32 color, ImU32 innerColor)
+{
+    IconTemplate key;
+    key.Type            = type;
+    key.Filled          = filled;
+    key.HasInner        = !filled && (innerColor & IM_COL32_A_MASK);
+    key.Size            = b - a;
+    key.Offset          = ImVec2(a.x - floorf(a.x), a.y - floorf(a.y));
+    key.FringeScale     = drawList->_FringeScale;
+    key.Flags           = drawList->Flags;
+    key.TexUvWhitePixel = drawList->_Data->TexUvWhitePixel;
+
+    auto shape = std::find_if(s_IconTemplates.begin(), s_IconTemplates.end(), [&key](const IconTemplate& shape) { return shape.Matches(key); });
+    if (shape == s_IconTemplates.end())
+    {
+        const auto vtxStart      = drawList->VtxBuffer.Size;
+        const auto idxStart      = drawList->IdxBuffer.Size;
+        const auto vtxIndexStart = drawList->_VtxCurrentIdx;
+        const auto vtxOffset     = drawList->_CmdHeader.VtxOffset;
+
+        TessellateIcon(drawList, a, b, type, filled, c_OuterRole, key.HasInner ? c_InnerRole : 0);
+
+        // Geometry crossing vertex offset cannot be stamped with single base index
+        if (drawList->_CmdHeader.VtxOffset == vtxOffset)
+        {
+            if (static_cast<int>(s_IconTemplates.size()) >= c_MaxIconTemplates)
+                s_IconTemplates.clear();
+
+            s_IconTemplates.push_back(key);
+
+            auto& capture = s_IconTemplates.back();
+
+            capture.Vertices.assign(drawList->VtxBuffer.Data + vtxStart, drawList->VtxBuffer.Data + drawList->VtxBuffer.Size);
+            for (auto& vertex : capture.Vertices)
+                vertex.pos -= a;
+
+            capture.Indices.resize(drawList->IdxBuffer.Size - idxStart);
+            for (size_t i = 0; i < capture.Indices.size(); ++i)
+                capture.Indices[i] = static_cast<ImDrawIdx>(drawList->IdxBuffer[idxStart + static_cast<int>(i)] - vtxIndexStart);
+        }
+
+        // Placeholder geometry is already in draw list, only colors are left to fix
+        for (int i = vtxStart; i < drawList->VtxBuffer.Size; ++i)
+            drawList->VtxBuffer[i].col = StampColor(drawList->VtxBuffer[i].col, color, innerColor);
+
+        return;
+    }
+
+    const auto vtxCount = static_cast<int>(shape->Vertices.size());
+    const auto idxCount = static_cast<int>(shape->Indices.size());
+
+    drawList->PrimReserve(idxCount, vtxCount);
+
+    const auto base = drawList->_VtxCurrentIdx;
+
+    auto vtx = drawList->_VtxWritePtr;
+    for (const auto& vertex : shape->Vertices)
+    {
+        vtx->pos = vertex.pos + a;
+        vtx->uv  = vertex.uv;
+        vtx->col = StampColor(vertex.col, color, innerColor);
+        ++vtx;
+    }
+
+    auto idx = drawList->_IdxWritePtr;
+    for (auto index : shape->Indices)
+        *idx++ = static_cast<ImDrawIdx>(index + base);
+
+    drawList->_VtxWritePtr   += vtxCount;
+    drawList->_IdxWritePtr   += idxCount;
+    drawList->_VtxCurrentIdx += vtxCount;
+}
+
+void ax::Drawing::ClearIconCache()
+{
+    s_IconTemplates.clear();
+}
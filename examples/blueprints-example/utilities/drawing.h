@@ -6,7 +6,9 @@ namespace Drawing {
 
 enum class IconType: ImU32 { Flow, Circle, Square, Grid, RoundSquare, Diamond };
 
+// Icons are tessellated once per size and draw list setup, then stamped from cache.
 void DrawIcon(ImDrawList* drawList, const ImVec2& a, const ImVec2& b, IconType type, bool filled, ImU32 color, ImU32 innerColor);
+void ClearIconCache();
 
 } // namespace Drawing
 } // namespace ax
\ No newline at end of file
@@ -16,6 +16,9 @@
 
 //------------------------------------------------------------------------------
 # include "imgui_extra_math.h"
+# if !defined(IMGUI_ENABLE_SSE) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#     include <arm_neon.h>
+# endif
 
 
 //------------------------------------------------------------------------------
@@ -40,6 +43,17 @@ template <typename T> inline T ImCubicBezier(const T& p0, const T& p1, const T&
 template <typename T> inline T ImCubicBezierDt(const T& p0, const T& p1, const T& p2, const T& p3, float t);
 
 
+// Batched Cubic Bezier sampling, evaluates every curve at every parameter. Results
+// are stored curve after curve, value for curve i at t[j] lands in out[i * t_count + j].
+// SSE or NEON is used when available, results are the same as of ImCubicBezier()
+// and ImCubicBezierDt() as long as compiler does not fuse multiply and add.
+// Generic versions evaluate one value at a time.
+inline void ImCubicBezierN(const ImCubicBezierPoints* curves, int curve_count, const float* t, int t_count, ImVec2* out_points);
+inline void ImCubicBezierDtN(const ImCubicBezierPoints* curves, int curve_count, const float* t, int t_count, ImVec2* out_derivatives);
+template <typename T> inline void ImCubicBezierN(const ImCubicBezierPointsT<T>* curves, int curve_count, const float* t, int t_count, T* out_points);
+template <typename T> inline void ImCubicBezierDtN(const ImCubicBezierPointsT<T>* curves, int curve_count, const float* t, int t_count, T* out_derivatives);
+
+
 // High-level Bezier sampling, automatically collapse to lower level Bezier curves if control points overlap.
 template <typename T> inline T ImCubicBezierSample(const T& p0, const T& p1, const T& p2, const T& p3, float t);
 template <typename T> inline T ImCubicBezierSample(const ImCubicBezierPointsT<T>& curve, float t);
@@ -78,8 +92,15 @@ struct ImProjectResult
     float  Distance; // Distance to curve
 };
 
-inline ImProjectResult ImProjectOnCubicBezier(const ImVec2& p, const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const int subdivisions = 100);
-inline ImProjectResult ImProjectOnCubicBezier(const ImVec2& p, const ImCubicBezierPoints& curve, const int subdivisions = 100);
+// Curve is sampled at 'subdivisions' points to bracket local minima of distance,
+// each one is refined with Newton's method.
+inline ImProjectResult ImProjectOnCubicBezier(const ImVec2& p, const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const int subdivisions = 16);
+inline ImProjectResult ImProjectOnCubicBezier(const ImVec2& p, const ImCubicBezierPoints& curve, const int subdivisions = 16);
+
+// Returns true if point lies within 'max_distance' from the curve. Cheaper than
+// projection, search ends at first part of the curve close enough.
+inline bool ImCubicBezierIsPointNear(const ImVec2& p, const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, float max_distance, const int subdivisions = 16);
+inline bool ImCubicBezierIsPointNear(const ImVec2& p, const ImCubicBezierPoints& curve, float max_distance, const int subdivisions = 16);
 
 
 // Calculate intersection between line and a Cubic Bezier curve.
@@ -92,6 +113,12 @@ struct ImCubicBezierIntersectResult
 inline ImCubicBezierIntersectResult ImCubicBezierLineIntersect(const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const ImVec2& a0, const ImVec2& a1);
 inline ImCubicBezierIntersectResult ImCubicBezierLineIntersect(const ImCubicBezierPoints& curve, const ImLine& line);
 
+// Returns true if any part of Cubic Bezier curve lies inside the rectangle. Curve
+// is accepted when end point is inside, rejected when bounds of control points
+// miss the rectangle and split in half otherwise.
+inline bool ImCubicBezierRectIntersect(const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const ImRect& rect);
+inline bool ImCubicBezierRectIntersect(const ImCubicBezierPoints& curve, const ImRect& rect);
+
 
 // Adaptive Cubic Bezier subdivision.
 enum ImCubicBezierSubdivideFlags
@@ -108,6 +135,12 @@ struct ImCubicBezierSubdivideSample
 
 using ImCubicBezierSubdivideCallback = void (*)(const ImCubicBezierSubdivideSample& p, void* user_pointer);
 
+// Tests flatness of two curves at once, the same way subdivision does for one. Curve is
+// flat when distances of control points from the chord, plus how far they reach past
+// its ends, sum up below tolerance. Bit 0 of result is set when 'a' is flat, bit 1
+// when 'b' is. Tolerance is squared.
+inline int ImCubicBezierIsFlat2(const ImCubicBezierPoints& a, const ImCubicBezierPoints& b, float tolerance);
+
 inline void ImCubicBezierSubdivide(ImCubicBezierSubdivideCallback callback, void* user_pointer, const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, float tess_tol = -1.0f, ImCubicBezierSubdivideFlags flags = ImCubicBezierSubdivide_None);
 inline void ImCubicBezierSubdivide(ImCubicBezierSubdivideCallback callback, void* user_pointer, const ImCubicBezierPoints& curve, float tess_tol = -1.0f, ImCubicBezierSubdivideFlags flags = ImCubicBezierSubdivide_None);
 
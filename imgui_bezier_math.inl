@@ -69,6 +69,151 @@ inline T ImCubicBezierDt(const T& p0, const T& p1, const T& p2, const T& p3, flo
     return -3 * p0 * b + 3 * p1 * (b - d) + 3 * p2 * (d - c) + 3 * p3 * c;
 }
 
+inline void ImCubicBezierN(const ImCubicBezierPoints* curves, int curve_count, const float* t, int t_count, ImVec2* out_points)
+{
+    for (int i = 0; i < curve_count; ++i)
+    {
+        const auto& curve = curves[i];
+        const auto  out   = out_points + i * t_count;
+
+        int j = 0;
+
+# if defined(IMGUI_ENABLE_SSE)
+        // Four parameters at once, operations are done in the same order as in ImCubicBezier()
+        const auto one   = _mm_set1_ps(1.0f);
+        const auto three = _mm_set1_ps(3.0f);
+        const auto p0x   = _mm_set1_ps(curve.P0.x), p0y = _mm_set1_ps(curve.P0.y);
+        const auto p1x   = _mm_set1_ps(curve.P1.x), p1y = _mm_set1_ps(curve.P1.y);
+        const auto p2x   = _mm_set1_ps(curve.P2.x), p2y = _mm_set1_ps(curve.P2.y);
+        const auto p3x   = _mm_set1_ps(curve.P3.x), p3y = _mm_set1_ps(curve.P3.y);
+
+        for (; j + 4 <= t_count; j += 4)
+        {
+            const auto tt = _mm_loadu_ps(t + j);
+            const auto a  = _mm_sub_ps(one, tt);
+            const auto b  = _mm_mul_ps(_mm_mul_ps(a, a), a);
+            const auto c  = _mm_mul_ps(_mm_mul_ps(tt, tt), tt);
+            const auto w1 = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(three, tt), a), a);
+            const auto w2 = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(three, tt), tt), a);
+
+            const auto x = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(b, p0x), _mm_mul_ps(w1, p1x)), _mm_mul_ps(w2, p2x)), _mm_mul_ps(c, p3x));
+            const auto y = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(b, p0y), _mm_mul_ps(w1, p1y)), _mm_mul_ps(w2, p2y)), _mm_mul_ps(c, p3y));
+
+            _mm_storeu_ps(&out[j].x,     _mm_unpacklo_ps(x, y));
+            _mm_storeu_ps(&out[j + 2].x, _mm_unpackhi_ps(x, y));
+        }
+# elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        // Separate multiply and add, fused one would round differently than scalar code
+        const auto one   = vdupq_n_f32(1.0f);
+        const auto three = vdupq_n_f32(3.0f);
+        const auto p0x   = vdupq_n_f32(curve.P0.x), p0y = vdupq_n_f32(curve.P0.y);
+        const auto p1x   = vdupq_n_f32(curve.P1.x), p1y = vdupq_n_f32(curve.P1.y);
+        const auto p2x   = vdupq_n_f32(curve.P2.x), p2y = vdupq_n_f32(curve.P2.y);
+        const auto p3x   = vdupq_n_f32(curve.P3.x), p3y = vdupq_n_f32(curve.P3.y);
+
+        for (; j + 4 <= t_count; j += 4)
+        {
+            const auto tt = vld1q_f32(t + j);
+            const auto a  = vsubq_f32(one, tt);
+            const auto b  = vmulq_f32(vmulq_f32(a, a), a);
+            const auto c  = vmulq_f32(vmulq_f32(tt, tt), tt);
+            const auto w1 = vmulq_f32(vmulq_f32(vmulq_f32(three, tt), a), a);
+            const auto w2 = vmulq_f32(vmulq_f32(vmulq_f32(three, tt), tt), a);
+
+            float32x4x2_t xy;
+            xy.val[0] = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(b, p0x), vmulq_f32(w1, p1x)), vmulq_f32(w2, p2x)), vmulq_f32(c, p3x));
+            xy.val[1] = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(b, p0y), vmulq_f32(w1, p1y)), vmulq_f32(w2, p2y)), vmulq_f32(c, p3y));
+
+            vst2q_f32(&out[j].x, xy);
+        }
+# endif
+
+        for (; j < t_count; ++j)
+            out[j] = ImCubicBezier(curve.P0, curve.P1, curve.P2, curve.P3, t[j]);
+    }
+}
+
+inline void ImCubicBezierDtN(const ImCubicBezierPoints* curves, int curve_count, const float* t, int t_count, ImVec2* out_derivatives)
+{
+    for (int i = 0; i < curve_count; ++i)
+    {
+        const auto& curve = curves[i];
+        const auto  out   = out_derivatives + i * t_count;
+
+        int j = 0;
+
+# if defined(IMGUI_ENABLE_SSE)
+        // Scaled control points are loop invariant, as in ImCubicBezierDt() they are scaled first
+        const auto one = _mm_set1_ps(1.0f);
+        const auto two = _mm_set1_ps(2.0f);
+        const auto q0x = _mm_set1_ps(-3 * curve.P0.x), q0y = _mm_set1_ps(-3 * curve.P0.y);
+        const auto q1x = _mm_set1_ps( 3 * curve.P1.x), q1y = _mm_set1_ps( 3 * curve.P1.y);
+        const auto q2x = _mm_set1_ps( 3 * curve.P2.x), q2y = _mm_set1_ps( 3 * curve.P2.y);
+        const auto q3x = _mm_set1_ps( 3 * curve.P3.x), q3y = _mm_set1_ps( 3 * curve.P3.y);
+
+        for (; j + 4 <= t_count; j += 4)
+        {
+            const auto tt = _mm_loadu_ps(t + j);
+            const auto a  = _mm_sub_ps(one, tt);
+            const auto b  = _mm_mul_ps(a, a);
+            const auto c  = _mm_mul_ps(tt, tt);
+            const auto d  = _mm_mul_ps(_mm_mul_ps(two, tt), a);
+            const auto w1 = _mm_sub_ps(b, d);
+            const auto w2 = _mm_sub_ps(d, c);
+
+            const auto x = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(q0x, b), _mm_mul_ps(q1x, w1)), _mm_mul_ps(q2x, w2)), _mm_mul_ps(q3x, c));
+            const auto y = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(q0y, b), _mm_mul_ps(q1y, w1)), _mm_mul_ps(q2y, w2)), _mm_mul_ps(q3y, c));
+
+            _mm_storeu_ps(&out[j].x,     _mm_unpacklo_ps(x, y));
+            _mm_storeu_ps(&out[j + 2].x, _mm_unpackhi_ps(x, y));
+        }
+# elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        const auto one = vdupq_n_f32(1.0f);
+        const auto two = vdupq_n_f32(2.0f);
+        const auto q0x = vdupq_n_f32(-3 * curve.P0.x), q0y = vdupq_n_f32(-3 * curve.P0.y);
+        const auto q1x = vdupq_n_f32( 3 * curve.P1.x), q1y = vdupq_n_f32( 3 * curve.P1.y);
+        const auto q2x = vdupq_n_f32( 3 * curve.P2.x), q2y = vdupq_n_f32( 3 * curve.P2.y);
+        const auto q3x = vdupq_n_f32( 3 * curve.P3.x), q3y = vdupq_n_f32( 3 * curve.P3.y);
+
+        for (; j + 4 <= t_count; j += 4)
+        {
+            const auto tt = vld1q_f32(t + j);
+            const auto a  = vsubq_f32(one, tt);
+            const auto b  = vmulq_f32(a, a);
+            const auto c  = vmulq_f32(tt, tt);
+            const auto d  = vmulq_f32(vmulq_f32(two, tt), a);
+            const auto w1 = vsubq_f32(b, d);
+            const auto w2 = vsubq_f32(d, c);
+
+            float32x4x2_t xy;
+            xy.val[0] = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(q0x, b), vmulq_f32(q1x, w1)), vmulq_f32(q2x, w2)), vmulq_f32(q3x, c));
+            xy.val[1] = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(q0y, b), vmulq_f32(q1y, w1)), vmulq_f32(q2y, w2)), vmulq_f32(q3y, c));
+
+            vst2q_f32(&out[j].x, xy);
+        }
+# endif
+
+        for (; j < t_count; ++j)
+            out[j] = ImCubicBezierDt(curve.P0, curve.P1, curve.P2, curve.P3, t[j]);
+    }
+}
+
+template <typename T>
+inline void ImCubicBezierN(const ImCubicBezierPointsT<T>* curves, int curve_count, const float* t, int t_count, T* out_points)
+{
+    for (int i = 0; i < curve_count; ++i)
+        for (int j = 0; j < t_count; ++j)
+            out_points[i * t_count + j] = ImCubicBezier(curves[i].P0, curves[i].P1, curves[i].P2, curves[i].P3, t[j]);
+}
+
+template <typename T>
+inline void ImCubicBezierDtN(const ImCubicBezierPointsT<T>* curves, int curve_count, const float* t, int t_count, T* out_derivatives)
+{
+    for (int i = 0; i < curve_count; ++i)
+        for (int j = 0; j < t_count; ++j)
+            out_derivatives[i * t_count + j] = ImCubicBezierDt(curves[i].P0, curves[i].P1, curves[i].P2, curves[i].P3, t[j]);
+}
+
 template <typename T>
 inline T ImCubicBezierSample(const T& p0, const T& p1, const T& p2, const T& p3, float t)
 {
@@ -176,22 +321,22 @@ inline float ImCubicBezierLength(const T& p0, const T& p1, const T& p2, const T&
 
     static_assert(sizeof(t_values) / sizeof(*t_values) == sizeof(c_values) / sizeof(*c_values), "");
 
-    auto arc = [p0, p1, p2, p3](float t)
-    {
-        const auto p = ImCubicBezierDt(p0, p1, p2, p3, t);
-        const auto l = ImLength(p);
-        return l;
-    };
-
     const auto z = 0.5f;
-    const auto n = sizeof(t_values) / sizeof(*t_values);
+    const int  n = static_cast<int>(sizeof(t_values) / sizeof(*t_values));
+
+    // Derivatives at all abscissae in one batch, SSE or NEON for ImVec2
+    float t[n];
+    for (int i = 0; i < n; ++i)
+        t[i] = z * t_values[i] + z;
+
+    const ImCubicBezierPointsT<T> curve = { p0, p1, p2, p3 };
+
+    T derivatives[n];
+    ImCubicBezierDtN(&curve, 1, t, n, derivatives);
 
     auto accumulator = 0.0f;
-    for (size_t i = 0; i < n; ++i)
-    {
-        const auto t = z * t_values[i] + z;
-        accumulator += c_values[i] * arc(t);
-    }
+    for (int i = 0; i < n; ++i)
+        accumulator += c_values[i] * ImLength(derivatives[i]);
 
     return z * accumulator;
 }
@@ -286,57 +431,159 @@ inline ImRect ImCubicBezierBoundingRect(const ImCubicBezierPoints& curve)
     return ImCubicBezierBoundingRect(curve.P0, curve.P1, curve.P2, curve.P3);
 }
 
-inline ImProjectResult ImProjectOnCubicBezier(const ImVec2& point, const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const int subdivisions)
+// Shared by ImProjectOnCubicBezier() and ImCubicBezierIsPointNear(). Search ends
+// as soon as point closer than 'stop_distance' is found.
+inline ImProjectResult ImProjectOnCubicBezierImpl(const ImVec2& point, const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, int subdivisions, float stop_distance)
 {
     // http://pomax.github.io/bezierinfo/#projections
+    //
+    // Closest point is a root of derivative of squared distance, which is
+    // a quintic. Coarse samples bracket roots by sign change of the derivative
+    // and each bracket is searched with Newton's method, falling back to
+    // bisection when step leaves the bracket.
+
+    const float epsilon   = 1e-6f;
+    const int   max_steps = 12;
+    const float stop_sq   = stop_distance * stop_distance;
+
+    subdivisions = ImMax(subdivisions, 2);
 
-    const float epsilon    = 1e-5f;
     const float fixed_step = 1.0f / static_cast<float>(subdivisions - 1);
 
+    // Power basis, B(t) = ((a * t + b) * t + c) * t + d
+    const auto a = p3 - 3 * p2 + 3 * p1 - p0;
+    const auto b = 3 * (p2 - 2 * p1 + p0);
+    const auto c = 3 * (p1 - p0);
+    const auto d = p0 - point; // curve relative to point
+
     ImProjectResult result;
     result.Point    = point;
     result.Time     = 0.0f;
     result.Distance = FLT_MAX;
 
-    // Step 1: Coarse check
-    for (int i = 0; i < subdivisions; ++i)
+    // Sign change from negative to positive of f(t) = (B(t) - P) . B'(t) marks local minimum
+    auto refine = [&](float t_min, float t_max, float f_min, float f_max)
     {
-        auto t = i * fixed_step;
-        auto p = ImCubicBezier(p0, p1, p2, p3, t);
-        auto s = point - p;
-        auto d = ImDot(s, s);
+        // Secant lands on bracket end when curve stops there (zero derivative
+        // makes f zero too), search from the middle then
+        auto t = t_min - f_min * (t_max - t_min) / (f_max - f_min);
+        if (!(t > t_min && t < t_max))
+            t = (t_min + t_max) * 0.5f;
+
+        for (int i = 0; i < max_steps; ++i)
+        {
+            const auto s   = ((a * t + b) * t + c) * t + d;
+            const auto dt  = (3 * a * t + 2 * b) * t + c;
+            const auto dt2 = 6 * a * t + 2 * b;
+
+            const auto f  = ImDot(s, dt);
+            const auto df = ImDot(dt, dt) + ImDot(s, dt2);
+
+            if (df > 0.0f && ImFabs(f) < epsilon * df)
+                break;
+
+            if (f < 0.0f)
+                t_min = t;
+            else
+                t_max = t;
+
+            auto next = df > 0.0f ? t - f / df : t_min;
+            if (next <= t_min || next >= t_max)
+                next = (t_min + t_max) * 0.5f;
 
-        if (d < result.Distance)
+            t = next;
+        }
+
+        const auto s = ((a * t + b) * t + c) * t + d;
+        const auto distance = ImDot(s, s);
+        if (distance < result.Distance)
         {
-            result.Point    = p;
+            result.Point    = point + s;
             result.Time     = t;
-            result.Distance = d;
+            result.Distance = distance;
         }
-    }
+    };
 
-    if (result.Time == 0.0f || ImFabs(result.Time - 1.0f) <= epsilon)
+    // Curve does not move faster than 3 * longest leg of control polygon, so
+    // distance between samples cannot drop below a bound. Brackets which stay
+    // farther than 'stop_distance' are not worth refining.
+    const auto max_travel = stop_distance > 0.0f
+        ? 3.0f * ImSqrt(ImMax(ImMax(ImLengthSqr(p1 - p0), ImLengthSqr(p2 - p1)), ImLengthSqr(p3 - p2))) * fixed_step
+        : 0.0f;
+
+    // Curve which stops at its end has zero derivative there, so f is zero as
+    // well and minimum right next to the end has no sign change to show it.
+    // Sign of f just inside the curve is taken from direction of first control
+    // point off the end instead.
+    const auto stops_at_start  = p1 == p0;
+    const auto stops_at_end    = p2 == p3;
+    const auto start_direction = !stops_at_start ? p1 - p0 : (p2 != p0 ? p2 - p0 : p3 - p0);
+    const auto end_direction   = !stops_at_end   ? p3 - p2 : (p1 != p3 ? p3 - p1 : p3 - p0);
+
+    // Distance going the other way between samples than derivative at sample
+    // says means local maximum and minimum are both hidden between them. Finer
+    // samples are searched for the sign change then.
+    const int scan_steps = 8;
+
+    auto scan = [&](float t_min, float t_max, float f_min, float f_max)
     {
-        result.Distance = ImSqrt(result.Distance);
-        return result;
-    }
+        const auto scan_step = (t_max - t_min) / static_cast<float>(scan_steps);
 
-    // Step 2: Fine check
-    auto left  = result.Time - fixed_step;
-    auto right = result.Time + fixed_step;
-    auto step  = fixed_step * 0.1f;
+        for (int i = 1; i <= scan_steps; ++i)
+        {
+            const auto t  = i < scan_steps ? t_min + i * scan_step : t_max;
+            const auto s  = ((a * t + b) * t + c) * t + d;
+            const auto dt = (3 * a * t + 2 * b) * t + c;
+            const auto f  = i < scan_steps ? ImDot(s, dt) : f_max;
 
-    for (auto t = left; t < right + step; t += step)
-    {
-        auto p = ImCubicBezier(p0, p1, p2, p3, t);
-        auto s = point - p;
-        auto d = ImDot(s, s);
+            if (f_min < 0.0f && f >= 0.0f)
+                return refine(t - scan_step, t, f_min, f);
 
-        if (d < result.Distance)
+            f_min = f;
+        }
+    };
+
+    float prev_t = 0.0f, prev_f = 0.0f, prev_distance = 0.0f, prev_distance_sq = 0.0f;
+    for (int i = 0; i < subdivisions; ++i)
+    {
+        const auto t  = i < subdivisions - 1 ? i * fixed_step : 1.0f;
+        const auto s  = ((a * t + b) * t + c) * t + d;
+        const auto dt = (3 * a * t + 2 * b) * t + c;
+
+        auto f = ImDot(s, dt);
+        if (i == 0 && stops_at_start)
+            f = ImDot(s, start_direction);
+        else if (i == subdivisions - 1 && stops_at_end)
+            f = ImDot(s, end_direction);
+
+        const auto distance = ImDot(s, s);
+        if (distance < result.Distance)
         {
-            result.Point    = p;
+            result.Point    = point + s;
             result.Time     = t;
-            result.Distance = d;
+            result.Distance = distance;
         }
+
+        if (result.Distance <= stop_sq)
+            break;
+
+        const auto distance_bound = max_travel > 0.0f ? ImSqrt(distance) : 0.0f;
+
+        if (i > 0 && (prev_distance + distance_bound - max_travel) * 0.5f <= stop_distance)
+        {
+            if (prev_f < 0.0f && f >= 0.0f)
+                refine(prev_t, t, prev_f, f);
+            else if ((prev_f >= 0.0f) == (f >= 0.0f) && (f >= 0.0f ? distance < prev_distance_sq : distance > prev_distance_sq))
+                scan(prev_t, t, prev_f, f);
+
+            if (result.Distance <= stop_sq)
+                break;
+        }
+
+        prev_t           = t;
+        prev_f           = f;
+        prev_distance    = distance_bound;
+        prev_distance_sq = distance;
     }
 
     result.Distance = ImSqrt(result.Distance);
@@ -344,11 +591,32 @@ inline ImProjectResult ImProjectOnCubicBezier(const ImVec2& point, const ImVec2&
     return result;
 }
 
+inline ImProjectResult ImProjectOnCubicBezier(const ImVec2& point, const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const int subdivisions)
+{
+    return ImProjectOnCubicBezierImpl(point, p0, p1, p2, p3, subdivisions, 0.0f);
+}
+
 inline ImProjectResult ImProjectOnCubicBezier(const ImVec2& p, const ImCubicBezierPoints& curve, const int subdivisions)
 {
     return ImProjectOnCubicBezier(p, curve.P0, curve.P1, curve.P2, curve.P3, subdivisions);
 }
 
+inline bool ImCubicBezierIsPointNear(const ImVec2& p, const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, float max_distance, const int subdivisions)
+{
+    // Curve never leaves bounds of its control points
+    const auto min = ImMin(ImMin(p0, p1), ImMin(p2, p3)) - ImVec2(max_distance, max_distance);
+    const auto max = ImMax(ImMax(p0, p1), ImMax(p2, p3)) + ImVec2(max_distance, max_distance);
+    if (p.x < min.x || p.y < min.y || p.x > max.x || p.y > max.y)
+        return false;
+
+    return ImProjectOnCubicBezierImpl(p, p0, p1, p2, p3, subdivisions, max_distance).Distance <= max_distance;
+}
+
+inline bool ImCubicBezierIsPointNear(const ImVec2& p, const ImCubicBezierPoints& curve, float max_distance, const int subdivisions)
+{
+    return ImCubicBezierIsPointNear(p, curve.P0, curve.P1, curve.P2, curve.P3, max_distance, subdivisions);
+}
+
 inline ImCubicBezierIntersectResult ImCubicBezierLineIntersect(const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const ImVec2& a0, const ImVec2& a1)
 {
     auto cubic_roots = [](float a, float b, float c, float d, float* roots) -> int
@@ -478,6 +746,140 @@ inline ImCubicBezierIntersectResult ImCubicBezierLineIntersect(const ImCubicBezi
     return ImCubicBezierLineIntersect(curve.P0, curve.P1, curve.P2, curve.P3, line.A, line.B);
 }
 
+inline bool ImCubicBezierRectIntersect(const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const ImRect& rect)
+{
+    // Curve lies within convex hull of its control points, so curve whose control
+    // points bounds miss the rectangle cannot touch it. Otherwise curve is split
+    // in half and both halves are tested. Halves shrink quickly, after
+    // 'max_depth' splits what is left of the curve is treated as a point.
+
+    const int max_depth = 16;
+
+    auto contains = [&rect](const ImVec2& p)
+    {
+        return p.x >= rect.Min.x && p.y >= rect.Min.y && p.x <= rect.Max.x && p.y <= rect.Max.y;
+    };
+
+    if (contains(p0) || contains(p3))
+        return true;
+
+    struct Segment
+    {
+        ImVec2 P0, P1, P2, P3;
+        int    Depth;
+    };
+
+    Segment stack[max_depth + 1];
+    int     stack_size = 0;
+
+    stack[stack_size++] = Segment{ p0, p1, p2, p3, 0 };
+
+    while (stack_size > 0)
+    {
+        const auto segment = stack[--stack_size];
+
+        const auto min = ImMin(ImMin(segment.P0, segment.P1), ImMin(segment.P2, segment.P3));
+        const auto max = ImMax(ImMax(segment.P0, segment.P1), ImMax(segment.P2, segment.P3));
+
+        if (max.x < rect.Min.x || max.y < rect.Min.y || min.x > rect.Max.x || min.y > rect.Max.y)
+            continue;
+
+        if (segment.Depth >= max_depth)
+            return true;
+
+        // de Casteljau split at t = 0.5
+        const auto p01  = (segment.P0 + segment.P1) * 0.5f;
+        const auto p12  = (segment.P1 + segment.P2) * 0.5f;
+        const auto p23  = (segment.P2 + segment.P3) * 0.5f;
+        const auto p012 = (p01 + p12) * 0.5f;
+        const auto p123 = (p12 + p23) * 0.5f;
+        const auto mid  = (p012 + p123) * 0.5f;
+
+        if (contains(mid))
+            return true;
+
+        stack[stack_size++] = Segment{ mid, p123, p23, segment.P3, segment.Depth + 1 };
+        stack[stack_size++] = Segment{ segment.P0, p01, p012, mid, segment.Depth + 1 };
+    }
+
+    return false;
+}
+
+inline bool ImCubicBezierRectIntersect(const ImCubicBezierPoints& curve, const ImRect& rect)
+{
+    return ImCubicBezierRectIntersect(curve.P0, curve.P1, curve.P2, curve.P3, rect);
+}
+
+inline int ImCubicBezierIsFlat2(const ImCubicBezierPoints& a, const ImCubicBezierPoints& b, float tolerance)
+{
+# if defined(IMGUI_ENABLE_SSE)
+    // Lanes hold distances of P1 and P2 from the chord of 'a', then the same for 'b'
+    const auto p0x = _mm_setr_ps(a.P0.x, a.P0.x, b.P0.x, b.P0.x), p0y = _mm_setr_ps(a.P0.y, a.P0.y, b.P0.y, b.P0.y);
+    const auto pkx = _mm_setr_ps(a.P1.x, a.P2.x, b.P1.x, b.P2.x), pky = _mm_setr_ps(a.P1.y, a.P2.y, b.P1.y, b.P2.y);
+    const auto p3x = _mm_setr_ps(a.P3.x, a.P3.x, b.P3.x, b.P3.x), p3y = _mm_setr_ps(a.P3.y, a.P3.y, b.P3.y, b.P3.y);
+
+    const auto zero = _mm_setzero_ps();
+    const auto dx   = _mm_sub_ps(p3x, p0x);
+    const auto dy   = _mm_sub_ps(p3y, p0y);
+    const auto l    = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+    auto       d    = _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(pkx, p3x), dy), _mm_mul_ps(_mm_sub_ps(pky, p3y), dx));
+    d = _mm_andnot_ps(_mm_set1_ps(-0.0f), d);
+
+    // Control point past end of the chord adds how far past it is
+    const auto e = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(pkx, p0x), dx), _mm_mul_ps(_mm_sub_ps(pky, p0y), dy));
+    d = _mm_add_ps(d, _mm_max_ps(_mm_max_ps(_mm_sub_ps(zero, e), _mm_sub_ps(e, l)), zero));
+
+    // d2 + d3 in both lanes of each curve
+    const auto s    = _mm_add_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 3, 0, 1)));
+    const auto lhs  = _mm_mul_ps(s, s);
+    const auto rhs  = _mm_mul_ps(_mm_set1_ps(tolerance), l);
+    const auto mask = _mm_movemask_ps(_mm_cmplt_ps(lhs, rhs));
+
+    return (mask & 1) | ((mask >> 1) & 2);
+# elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const float p0x_lanes[4] = { a.P0.x, a.P0.x, b.P0.x, b.P0.x }, p0y_lanes[4] = { a.P0.y, a.P0.y, b.P0.y, b.P0.y };
+    const float pkx_lanes[4] = { a.P1.x, a.P2.x, b.P1.x, b.P2.x }, pky_lanes[4] = { a.P1.y, a.P2.y, b.P1.y, b.P2.y };
+    const float p3x_lanes[4] = { a.P3.x, a.P3.x, b.P3.x, b.P3.x }, p3y_lanes[4] = { a.P3.y, a.P3.y, b.P3.y, b.P3.y };
+    const auto p0x = vld1q_f32(p0x_lanes), p0y = vld1q_f32(p0y_lanes);
+    const auto pkx = vld1q_f32(pkx_lanes), pky = vld1q_f32(pky_lanes);
+    const auto p3x = vld1q_f32(p3x_lanes), p3y = vld1q_f32(p3y_lanes);
+
+    const auto zero = vdupq_n_f32(0.0f);
+    const auto dx   = vsubq_f32(p3x, p0x);
+    const auto dy   = vsubq_f32(p3y, p0y);
+    const auto l    = vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy));
+    const auto e    = vaddq_f32(vmulq_f32(vsubq_f32(pkx, p0x), dx), vmulq_f32(vsubq_f32(pky, p0y), dy));
+    const auto d    = vaddq_f32(
+        vabsq_f32(vsubq_f32(vmulq_f32(vsubq_f32(pkx, p3x), dy), vmulq_f32(vsubq_f32(pky, p3y), dx))),
+        vmaxq_f32(vmaxq_f32(vsubq_f32(zero, e), vsubq_f32(e, l)), zero));
+
+    const auto s    = vaddq_f32(d, vrev64q_f32(d));
+    const auto lhs  = vmulq_f32(s, s);
+    const auto rhs  = vmulq_f32(vdupq_n_f32(tolerance), l);
+    const auto mask = vcltq_f32(lhs, rhs);
+
+    return (vgetq_lane_u32(mask, 0) & 1) | (vgetq_lane_u32(mask, 2) & 2);
+# else
+    auto is_flat = [tolerance](const ImCubicBezierPoints& c)
+    {
+        float dx = c.P3.x - c.P0.x;
+        float dy = c.P3.y - c.P0.y;
+        float l  = dx * dx + dy * dy;
+        float d2 = ((c.P1.x - c.P3.x) * dy - (c.P1.y - c.P3.y) * dx);
+        float d3 = ((c.P2.x - c.P3.x) * dy - (c.P2.y - c.P3.y) * dx);
+        float e2 = ((c.P1.x - c.P0.x) * dx + (c.P1.y - c.P0.y) * dy);
+        float e3 = ((c.P2.x - c.P0.x) * dx + (c.P2.y - c.P0.y) * dy);
+        d2 = (d2 >= 0) ? d2 : -d2;
+        d3 = (d3 >= 0) ? d3 : -d3;
+        d2 += ImMax(ImMax(-e2, e2 - l), 0.0f);
+        d3 += ImMax(ImMax(-e3, e3 - l), 0.0f);
+        return (d2 + d3) * (d2 + d3) < tolerance * l;
+    };
+
+    return (is_flat(a) ? 1 : 0) | (is_flat(b) ? 2 : 0);
+# endif
+}
+
 inline void ImCubicBezierSubdivide(ImCubicBezierSubdivideCallback callback, void* user_pointer, const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, float tess_tol, ImCubicBezierSubdivideFlags flags)
 {
     return ImCubicBezierSubdivide(callback, user_pointer, ImCubicBezierPoints{ p0, p1, p2, p3 }, tess_tol, flags);
@@ -485,61 +887,75 @@ inline void ImCubicBezierSubdivide(ImCubicBezierSubdivideCallback callback, void
 
 inline void ImCubicBezierSubdivide(ImCubicBezierSubdivideCallback callback, void* user_pointer, const ImCubicBezierPoints& curve, float tess_tol, ImCubicBezierSubdivideFlags flags)
 {
-    struct Tesselator
-    {
-        ImCubicBezierSubdivideCallback  Callback;
-        void*                           UserPointer;
-        float                           TesselationTollerance;
-        ImCubicBezierSubdivideFlags     Flags;
+    // Same subdivision as ImDrawList::PathBezierCubicCurveTo() does, with
+    // explicit stack instead of recursion. Pieces are split in half until they
+    // are flat enough, at most 'max_level' times. Flatness of both halves is
+    // tested at once when piece is split.
+    //
+    // Unlike ImGui, control points past ends of the chord count against
+    // flatness too. Otherwise curve with control points along the chord, like
+    // horizontal link going back, is taken as flat and drawn without parts
+    // going past its ends.
 
-        void Commit(const ImVec2& p, const ImVec2& t)
-        {
-            ImCubicBezierSubdivideSample sample;
-            sample.Point = p;
-            sample.Tangent = t;
-            Callback(sample, UserPointer);
-        }
+    const int max_level = 10;
 
-        void Subdivide(const ImCubicBezierPoints& curve, int level = 0)
-        {
-            float dx = curve.P3.x - curve.P0.x;
-            float dy = curve.P3.y - curve.P0.y;
-            float d2 = ((curve.P1.x - curve.P3.x) * dy - (curve.P1.y - curve.P3.y) * dx);
-            float d3 = ((curve.P2.x - curve.P3.x) * dy - (curve.P2.y - curve.P3.y) * dx);
-            d2 = (d2 >= 0) ? d2 : -d2;
-            d3 = (d3 >= 0) ? d3 : -d3;
-            if ((d2 + d3) * (d2 + d3) < TesselationTollerance * (dx * dx + dy * dy))
-            {
-                Commit(curve.P3, ImCubicBezierTangent(curve, 1.0f));
-            }
-            else if (level < 10)
-            {
-                const auto p12 = (curve.P0 + curve.P1) * 0.5f;
-                const auto p23 = (curve.P1 + curve.P2) * 0.5f;
-                const auto p34 = (curve.P2 + curve.P3) * 0.5f;
-                const auto p123 = (p12 + p23) * 0.5f;
-                const auto p234 = (p23 + p34) * 0.5f;
-                const auto p1234 = (p123 + p234) * 0.5f;
-
-                Subdivide(ImCubicBezierPoints { curve.P0, p12, p123, p1234 }, level + 1);
-                Subdivide(ImCubicBezierPoints { p1234, p234, p34, curve.P3 }, level + 1);
-            }
-        }
+    struct Segment
+    {
+        ImCubicBezierPoints Curve;
+        int                 Level;
+        bool                IsFlat;
+    };
+
+    auto commit = [callback, user_pointer](const ImVec2& p, const ImVec2& t)
+    {
+        ImCubicBezierSubdivideSample sample;
+        sample.Point   = p;
+        sample.Tangent = t;
+        callback(sample, user_pointer);
     };
 
     if (tess_tol < 0)
         tess_tol = 1.118f; // sqrtf(1.25f)
 
-    Tesselator tesselator;
-    tesselator.Callback              = callback;
-    tesselator.UserPointer           = user_pointer;
-    tesselator.TesselationTollerance = tess_tol * tess_tol;
-    tesselator.Flags                 = flags;
+    const auto tolerance = tess_tol * tess_tol;
+
+    if (!(flags & ImCubicBezierSubdivide_SkipFirst))
+        commit(curve.P0, ImCubicBezierTangent(curve, 0.0f));
 
-    if (!(tesselator.Flags & ImCubicBezierSubdivide_SkipFirst))
-        tesselator.Commit(curve.P0, ImCubicBezierTangent(curve, 0.0f));
+    Segment stack[max_level + 2];
+    int     stack_size = 0;
 
-    tesselator.Subdivide(curve, 0);
+    stack[stack_size++] = Segment{ curve, 0, (ImCubicBezierIsFlat2(curve, curve, tolerance) & 1) != 0 };
+
+    while (stack_size > 0)
+    {
+        const auto segment = stack[--stack_size];
+        const auto& c      = segment.Curve;
+
+        // Piece which is still not flat at last level is taken as is, instead
+        // of being dropped
+        if (segment.Level >= max_level || segment.IsFlat)
+        {
+            commit(c.P3, ImCubicBezierTangent(c, 1.0f));
+        }
+        else
+        {
+            const auto p12   = (c.P0 + c.P1) * 0.5f;
+            const auto p23   = (c.P1 + c.P2) * 0.5f;
+            const auto p34   = (c.P2 + c.P3) * 0.5f;
+            const auto p123  = (p12 + p23) * 0.5f;
+            const auto p234  = (p23 + p34) * 0.5f;
+            const auto p1234 = (p123 + p234) * 0.5f;
+
+            const auto left    = ImCubicBezierPoints{ c.P0, p12, p123, p1234 };
+            const auto right   = ImCubicBezierPoints{ p1234, p234, p34, c.P3 };
+            const auto is_flat = ImCubicBezierIsFlat2(left, right, tolerance);
+
+            // Second half is pushed first, so first half is processed first
+            stack[stack_size++] = Segment{ right, segment.Level + 1, (is_flat & 2) != 0 };
+            stack[stack_size++] = Segment{ left,  segment.Level + 1, (is_flat & 1) != 0 };
+        }
+    }
 }
 
 template <typename F> inline void ImCubicBezierSubdivide(F& callback, const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, float tess_tol, ImCubicBezierSubdivideFlags flags)
@@ -3,6 +3,9 @@
 # endif
 # include "imgui_canvas.h"
 # include <type_traits>
+# if !defined(IMGUI_ENABLE_SSE) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#     include <arm_neon.h>
+# endif
 
 // https://stackoverflow.com/a/36079786
 # define DECLARE_HAS_MEMBER(__trait_name__, __member_name__)                         \
@@ -92,6 +95,83 @@ static inline unsigned int& ImVtxOffsetRef(ImDrawList* drawList)
 
 static inline ImVec2 ImSelectPositive(const ImVec2& lhs, const ImVec2& rhs) { return ImVec2(lhs.x > 0.0f ? lhs.x : rhs.x, lhs.y > 0.0f ? lhs.y : rhs.y); }
 
+void ImGuiEx::TransformVertices(ImDrawVert* begin, ImDrawVert* end, const ImVec2& preOffset, float scale, const ImVec2& postOffset)
+{
+    auto vertex = begin;
+
+# if defined(IMGUI_ENABLE_SSE)
+    // Positions of two vertices are packed in one register
+    const auto pre  = _mm_setr_ps(preOffset.x,  preOffset.y,  preOffset.x,  preOffset.y);
+    const auto post = _mm_setr_ps(postOffset.x, postOffset.y, postOffset.x, postOffset.y);
+    const auto mul  = _mm_set1_ps(scale);
+
+    for (; vertex + 4 <= end; vertex += 4)
+    {
+        auto a = _mm_loadh_pi(_mm_loadl_pi(pre, reinterpret_cast<const __m64*>(&vertex[0].pos)), reinterpret_cast<const __m64*>(&vertex[1].pos));
+        auto b = _mm_loadh_pi(_mm_loadl_pi(pre, reinterpret_cast<const __m64*>(&vertex[2].pos)), reinterpret_cast<const __m64*>(&vertex[3].pos));
+
+        a = _mm_add_ps(_mm_mul_ps(_mm_add_ps(a, pre), mul), post);
+        b = _mm_add_ps(_mm_mul_ps(_mm_add_ps(b, pre), mul), post);
+
+        _mm_storel_pi(reinterpret_cast<__m64*>(&vertex[0].pos), a);
+        _mm_storeh_pi(reinterpret_cast<__m64*>(&vertex[1].pos), a);
+        _mm_storel_pi(reinterpret_cast<__m64*>(&vertex[2].pos), b);
+        _mm_storeh_pi(reinterpret_cast<__m64*>(&vertex[3].pos), b);
+    }
+# elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const auto pre  = vcombine_f32(vld1_f32(&preOffset.x),  vld1_f32(&preOffset.x));
+    const auto post = vcombine_f32(vld1_f32(&postOffset.x), vld1_f32(&postOffset.x));
+    const auto mul  = vdupq_n_f32(scale);
+
+    for (; vertex + 2 <= end; vertex += 2)
+    {
+        auto p = vcombine_f32(vld1_f32(&vertex[0].pos.x), vld1_f32(&vertex[1].pos.x));
+
+        // Separate multiply and add, fused one would round differently than scalar code
+        p = vaddq_f32(vmulq_f32(vaddq_f32(p, pre), mul), post);
+
+        vst1_f32(&vertex[0].pos.x, vget_low_f32(p));
+        vst1_f32(&vertex[1].pos.x, vget_high_f32(p));
+    }
+# endif
+
+    for (; vertex < end; ++vertex)
+    {
+        vertex->pos.x = (vertex->pos.x + preOffset.x) * scale + postOffset.x;
+        vertex->pos.y = (vertex->pos.y + preOffset.y) * scale + postOffset.y;
+    }
+}
+
+void ImGuiEx::TransformClipRects(ImDrawCmd* begin, ImDrawCmd* end, const ImVec2& preOffset, float scale, const ImVec2& postOffset)
+{
+    auto command = begin;
+
+# if defined(IMGUI_ENABLE_SSE)
+    const auto pre  = _mm_setr_ps(preOffset.x,  preOffset.y,  preOffset.x,  preOffset.y);
+    const auto post = _mm_setr_ps(postOffset.x, postOffset.y, postOffset.x, postOffset.y);
+    const auto mul  = _mm_set1_ps(scale);
+
+    for (; command < end; ++command)
+        _mm_storeu_ps(&command->ClipRect.x, _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&command->ClipRect.x), pre), mul), post));
+# elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const auto pre  = vcombine_f32(vld1_f32(&preOffset.x),  vld1_f32(&preOffset.x));
+    const auto post = vcombine_f32(vld1_f32(&postOffset.x), vld1_f32(&postOffset.x));
+    const auto mul  = vdupq_n_f32(scale);
+
+    for (; command < end; ++command)
+        vst1q_f32(&command->ClipRect.x, vaddq_f32(vmulq_f32(vaddq_f32(vld1q_f32(&command->ClipRect.x), pre), mul), post));
+# else
+    for (; command < end; ++command)
+    {
+        auto& clipRect = command->ClipRect;
+        clipRect.x = (clipRect.x + preOffset.x) * scale + postOffset.x;
+        clipRect.y = (clipRect.y + preOffset.y) * scale + postOffset.y;
+        clipRect.z = (clipRect.z + preOffset.x) * scale + postOffset.x;
+        clipRect.w = (clipRect.w + preOffset.y) * scale + postOffset.y;
+    }
+# endif
+}
+
 bool ImGuiEx::Canvas::Begin(const char* id, const ImVec2& size)
 {
     return Begin(ImGui::GetID(id), size);
@@ -136,6 +216,8 @@ bool ImGuiEx::Canvas::Begin(ImGuiID id, const ImVec2& size)
     // Record cursor max to prevent scrollbars from appearing.
     m_WindowCursorMaxBackup = ImGui::GetCurrentWindow()->DC.CursorMaxPos;
 
+    m_ClipMargin = ImVec2(0.0f, 0.0f);
+
     EnterLocalSpace();
 
 # if IMGUI_VERSION_NUM >= 18967
@@ -171,6 +253,10 @@ void ImGuiEx::Canvas::End()
 
     LeaveLocalSpace();
 
+# if IMGUI_EX_CANVAS_DEFERED()
+    TransformRanges();
+# endif
+
     ImGui::GetCurrentWindow()->DC.CursorMaxPos = m_WindowCursorMaxBackup;
 
 # if IMGUI_VERSION_NUM < 18967
@@ -295,6 +381,23 @@ void ImGuiEx::Canvas::Resume()
         EnterLocalSpace();
 }
 
+void ImGuiEx::Canvas::SetClipMargin(const ImVec2& margin)
+{
+    IM_ASSERT(m_InBeginEnd == true);
+    IM_ASSERT(m_DrawList->_Splitter._Current == m_ExpectedChannel);
+
+    m_ClipMargin = margin;
+
+    // Clip rectangle is pushed again when resumed
+    if (IsSuspended())
+        return;
+
+    ImGui::PopClipRect();
+    ImGui::PushClipRect(
+        ImVec2(m_VisibleClipRect.x - m_ClipMargin.x, m_VisibleClipRect.y - m_ClipMargin.y),
+        ImVec2(m_VisibleClipRect.z + m_ClipMargin.x, m_VisibleClipRect.w + m_ClipMargin.y), false);
+}
+
 ImVec2 ImGuiEx::Canvas::FromLocal(const ImVec2& point) const
 {
     return point * m_View.Scale + m_ViewTransformPosition;
@@ -421,13 +524,29 @@ void ImGuiEx::Canvas::EnterLocalSpace()
     ImGui::PopClipRect();
 
 # if IMGUI_EX_CANVAS_DEFERED()
-    m_Ranges.resize(m_Ranges.Size + 1);
-    m_CurrentRange = &m_Ranges.back();
-    m_CurrentRange->BeginComandIndex = ImMax(m_DrawList->CmdBuffer.Size, 0);
-    m_CurrentRange->BeginVertexIndex = m_DrawList->_VtxCurrentIdx + ImVtxOffsetRef(m_DrawList);
+    const auto vertexIndex = static_cast<int>(m_DrawList->_VtxCurrentIdx + ImVtxOffsetRef(m_DrawList));
+
+    // Continue previous range if nothing was drawn while suspended
+    // and view did not change in the meantime.
+    auto lastRange = m_Ranges.empty() ? nullptr : &m_Ranges.back();
+    if (lastRange && lastRange->EndVertexIndex == vertexIndex && lastRange->Scale == m_View.Scale
+        && lastRange->Offset.x == m_ViewTransformPosition.x && lastRange->Offset.y == m_ViewTransformPosition.y)
+    {
+        m_CurrentRange = lastRange;
+    }
+    else
+    {
+        m_Ranges.resize(m_Ranges.Size + 1);
+        m_CurrentRange = &m_Ranges.back();
+        m_CurrentRange->BeginVertexIndex = vertexIndex;
+        m_CurrentRange->Scale            = m_View.Scale;
+        m_CurrentRange->Offset           = m_ViewTransformPosition;
+    }
+    m_CurrentRange->EndVertexIndex = vertexIndex;
+# else
+    m_DrawListStartVertexIndex  = m_DrawList->_VtxCurrentIdx + ImVtxOffsetRef(m_DrawList);
 # endif
-    m_DrawListCommadBufferSize       = ImMax(m_DrawList->CmdBuffer.Size, 0);
-    m_DrawListStartVertexIndex       = m_DrawList->_VtxCurrentIdx + ImVtxOffsetRef(m_DrawList);
+    m_DrawListCommadBufferSize  = ImMax(m_DrawList->CmdBuffer.Size, 0);
 
     // Make sure we do not share draw command with anyone. We don't want to mess
     // with someones clip rectangle.
@@ -477,7 +596,10 @@ void ImGuiEx::Canvas::EnterLocalSpace()
     clipped_clip_rect.y = (clipped_clip_rect.y - m_ViewTransformPosition.y) * m_View.InvScale;
     clipped_clip_rect.z = (clipped_clip_rect.z - m_ViewTransformPosition.x) * m_View.InvScale;
     clipped_clip_rect.w = (clipped_clip_rect.w - m_ViewTransformPosition.y) * m_View.InvScale;
-    ImGui::PushClipRect(ImVec2(clipped_clip_rect.x, clipped_clip_rect.y), ImVec2(clipped_clip_rect.z, clipped_clip_rect.w), false);
+    m_VisibleClipRect = clipped_clip_rect;
+    ImGui::PushClipRect(
+        ImVec2(clipped_clip_rect.x - m_ClipMargin.x, clipped_clip_rect.y - m_ClipMargin.y),
+        ImVec2(clipped_clip_rect.z + m_ClipMargin.x, clipped_clip_rect.w + m_ClipMargin.y), false);
 
     // Transform mouse position to local space.
     auto& io = ImGui::GetIO();
@@ -500,59 +622,40 @@ void ImGuiEx::Canvas::LeaveLocalSpace()
 # if IMGUI_EX_CANVAS_DEFERED()
     IM_ASSERT(m_CurrentRange != nullptr);
 
-    m_CurrentRange->EndVertexIndex  = m_DrawList->_VtxCurrentIdx + ImVtxOffsetRef(m_DrawList);
-    m_CurrentRange->EndCommandIndex = m_DrawList->CmdBuffer.size();
+    m_CurrentRange->EndVertexIndex = m_DrawList->_VtxCurrentIdx + ImVtxOffsetRef(m_DrawList);
     if (m_CurrentRange->BeginVertexIndex == m_CurrentRange->EndVertexIndex)
     {
         // Drop empty range
         m_Ranges.resize(m_Ranges.Size - 1);
     }
     m_CurrentRange = nullptr;
+# else
+    // Move vertices to screen space.
+    auto vertex     = m_DrawList->VtxBuffer.Data + m_DrawListStartVertexIndex;
+    auto vertexEnd  = m_DrawList->VtxBuffer.Data + m_DrawList->_VtxCurrentIdx + ImVtxOffsetRef(m_DrawList);
+
+    TransformVertices(vertex, vertexEnd, ImVec2(0.0f, 0.0f), m_View.Scale, m_ViewTransformPosition);
 # endif
 
-    // Move vertices to screen space.
-    auto vertex    = m_DrawList->VtxBuffer.Data + m_DrawListStartVertexIndex;
-    auto vertexEnd = m_DrawList->VtxBuffer.Data + m_DrawList->_VtxCurrentIdx + ImVtxOffsetRef(m_DrawList);
+    // Move clip rectangles to screen space. Their number is proportional to
+    // draw commands, not geometry, so this is done eagerly.
+    auto command    = m_DrawList->CmdBuffer.Data + m_DrawListFirstCommandIndex;
+    auto commandEnd = m_DrawList->CmdBuffer.Data + m_DrawList->CmdBuffer.Size;
 
-    // If canvas view is not scaled take a faster path.
-    if (m_View.Scale != 1.0f)
+    // Content drawn in margin must not show up outside of visible region.
+    if (m_ClipMargin.x != 0.0f || m_ClipMargin.y != 0.0f)
     {
-        while (vertex < vertexEnd)
+        for (auto clipCommand = command; clipCommand < commandEnd; ++clipCommand)
         {
-            vertex->pos.x = vertex->pos.x * m_View.Scale + m_ViewTransformPosition.x;
-            vertex->pos.y = vertex->pos.y * m_View.Scale + m_ViewTransformPosition.y;
-            ++vertex;
-        }
-
-        // Move clip rectangles to screen space.
-        for (int i = m_DrawListFirstCommandIndex; i < m_DrawList->CmdBuffer.size(); ++i)
-        {
-            auto& command = m_DrawList->CmdBuffer[i];
-            command.ClipRect.x = command.ClipRect.x * m_View.Scale + m_ViewTransformPosition.x;
-            command.ClipRect.y = command.ClipRect.y * m_View.Scale + m_ViewTransformPosition.y;
-            command.ClipRect.z = command.ClipRect.z * m_View.Scale + m_ViewTransformPosition.x;
-            command.ClipRect.w = command.ClipRect.w * m_View.Scale + m_ViewTransformPosition.y;
+            auto& clipRect = clipCommand->ClipRect;
+            clipRect.x = ImMax(clipRect.x, m_VisibleClipRect.x);
+            clipRect.y = ImMax(clipRect.y, m_VisibleClipRect.y);
+            clipRect.z = ImMin(clipRect.z, m_VisibleClipRect.z);
+            clipRect.w = ImMin(clipRect.w, m_VisibleClipRect.w);
         }
     }
-    else
-    {
-        while (vertex < vertexEnd)
-        {
-            vertex->pos.x = vertex->pos.x + m_ViewTransformPosition.x;
-            vertex->pos.y = vertex->pos.y + m_ViewTransformPosition.y;
-            ++vertex;
-        }
 
-        // Move clip rectangles to screen space.
-        for (int i = m_DrawListFirstCommandIndex; i < m_DrawList->CmdBuffer.size(); ++i)
-        {
-            auto& command = m_DrawList->CmdBuffer[i];
-            command.ClipRect.x = command.ClipRect.x + m_ViewTransformPosition.x;
-            command.ClipRect.y = command.ClipRect.y + m_ViewTransformPosition.y;
-            command.ClipRect.z = command.ClipRect.z + m_ViewTransformPosition.x;
-            command.ClipRect.w = command.ClipRect.w + m_ViewTransformPosition.y;
-        }
-    }
+    TransformClipRects(command, commandEnd, ImVec2(0.0f, 0.0f), m_View.Scale, m_ViewTransformPosition);
 
     // Remove sentinel draw command if present
     if (m_DrawListCommadBufferSize > 0)
@@ -572,3 +675,40 @@ void ImGuiEx::Canvas::LeaveLocalSpace()
     RestoreInputState();
     RestoreViewportState();
 }
+
+bool ImGuiEx::Canvas::IsLocalSpace(int vertexIndex) const
+{
+# if IMGUI_EX_CANVAS_DEFERED()
+    const auto currentVertexIndex = static_cast<int>(m_DrawList->_VtxCurrentIdx + ImVtxOffsetRef(m_DrawList));
+
+    // Ranges are ordered, any gap between them was drawn while suspended
+    for (auto& range : m_Ranges)
+    {
+        const auto endVertexIndex = &range == m_CurrentRange ? currentVertexIndex : range.EndVertexIndex;
+        if (endVertexIndex <= vertexIndex)
+            continue;
+        if (range.BeginVertexIndex > vertexIndex)
+            return false;
+
+        vertexIndex = endVertexIndex;
+    }
+
+    return vertexIndex >= currentVertexIndex;
+# else
+    IM_UNUSED(vertexIndex);
+    return false;
+# endif
+}
+
+# if IMGUI_EX_CANVAS_DEFERED()
+void ImGuiEx::Canvas::TransformRanges()
+{
+    IM_ASSERT(m_CurrentRange == nullptr);
+
+    auto vertices = m_DrawList->VtxBuffer.Data;
+    for (auto& range : m_Ranges)
+        TransformVertices(vertices + range.BeginVertexIndex, vertices + range.EndVertexIndex, ImVec2(0.0f, 0.0f), range.Scale, range.Offset);
+
+    m_Ranges.resize(0);
+}
+# endif
@@ -153,6 +153,15 @@ struct Canvas
     IMGUIEX_CANVAS_API void Suspend();
     IMGUIEX_CANVAS_API void Resume();
 
+    // Extends clip rectangle by margin (in canvas plane units) on each
+    // side, so content around visible region is drawn too. Clip rectangles
+    // of draw commands are narrowed back to visible region when leaving
+    // canvas plane.
+    //
+    // Note:
+    //     Margin is reset to zero by Begin().
+    IMGUIEX_CANVAS_API void SetClipMargin(const ImVec2& margin);
+
     // Transforms point from canvas plane to ImGui.
     IMGUIEX_CANVAS_API ImVec2 FromLocal(const ImVec2& point) const;
     IMGUIEX_CANVAS_API ImVec2 FromLocal(const ImVec2& point, const CanvasView& view) const;
@@ -198,17 +207,30 @@ struct Canvas
     // See: Suspend()/Resume()
     bool IsSuspended() const { return m_SuspendCounter > 0; }
 
+    // Returns true if every vertex emitted since vertexIndex was drawn
+    // on canvas plane, not while canvas was suspended.
+    //
+    // Note:
+    //     Always false when vertices are moved to screen space before End().
+    IMGUIEX_CANVAS_API bool IsLocalSpace(int vertexIndex) const;
+
 private:
-# define IMGUI_EX_CANVAS_DEFERED() 0
+# define IMGUI_EX_CANVAS_DEFERED() 1
 
 # if IMGUI_EX_CANVAS_DEFERED()
+    // Span of vertices emitted in local space. Ranges are moved to screen
+    // space all at once in End(), so Suspend()/Resume() do not touch
+    // geometry. Only vertex indices are recorded, command indices are
+    // not stable while channels are being merged.
     struct Range
     {
-        int BeginVertexIndex = 0;
-        int EndVertexIndex   = 0;
-        int BeginComandIndex = 0;
-        int EndCommandIndex  = 0;
+        int    BeginVertexIndex = 0;
+        int    EndVertexIndex   = 0;
+        float  Scale            = 1.0f;
+        ImVec2 Offset;
     };
+
+    void TransformRanges();
 # endif
 
     void UpdateViewTransformPosition();
@@ -238,11 +260,16 @@ private:
 
     int m_DrawListFirstCommandIndex = 0;
     int m_DrawListCommadBufferSize = 0;
+# if !IMGUI_EX_CANVAS_DEFERED()
     int m_DrawListStartVertexIndex = 0;
+# endif
 
     CanvasView  m_View;
     ImRect      m_ViewRect;
 
+    ImVec2 m_ClipMargin;
+    ImVec4 m_VisibleClipRect;
+
     ImVec2 m_ViewTransformPosition;
 
     int m_SuspendCounter = 0;
@@ -268,6 +295,13 @@ private:
 # endif
 };
 
+// Transforms vertex positions and clip rectangles with '(p + preOffset) * scale + postOffset'.
+//
+// Canvas use these to move content between canvas plane and ImGui space.
+// SSE or NEON is used when available, result is the same as of scalar code.
+IMGUIEX_CANVAS_API void TransformVertices(ImDrawVert* begin, ImDrawVert* end, const ImVec2& preOffset, float scale, const ImVec2& postOffset);
+IMGUIEX_CANVAS_API void TransformClipRects(ImDrawCmd* begin, ImDrawCmd* end, const ImVec2& preOffset, float scale, const ImVec2& postOffset);
+
 } // namespace ImGuiEx
 
 # endif // __IMGUI_EX_CANVAS_H__
\ No newline at end of file
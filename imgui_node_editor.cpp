@@ -19,6 +19,9 @@
 # include <sstream>
 # include <streambuf>
 # include <type_traits>
+# if !defined(IMGUI_ENABLE_SSE) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#     include <arm_neon.h>
+# endif
 
 // https://stackoverflow.com/a/8597498
 # define DECLARE_HAS_NESTED(Name, Member)                                          \
@@ -93,16 +96,23 @@ namespace ed = ax::NodeEditor::Detail;
 
 //------------------------------------------------------------------------------
 static const int c_BackgroundChannelCount = 1;
+static const int c_GroupChannelCount      = 1;
 static const int c_LinkChannelCount       = 4;
+static const int c_NodeChannelCount       = 1;
 static const int c_UserLayersCount        = 5;
 
 static const int c_UserLayerChannelStart  = 0;
 static const int c_BackgroundChannelStart = c_UserLayerChannelStart  + c_UserLayersCount;
-static const int c_LinkStartChannel       = c_BackgroundChannelStart + c_BackgroundChannelCount;
+static const int c_GroupStartChannel      = c_BackgroundChannelStart + c_BackgroundChannelCount;
+static const int c_LinkStartChannel       = c_GroupStartChannel      + c_GroupChannelCount;
 static const int c_NodeStartChannel       = c_LinkStartChannel       + c_LinkChannelCount;
+static const int c_ChannelCount           = c_NodeStartChannel       + c_NodeChannelCount;
 
 static const int c_BackgroundChannel_SelectionRect = c_BackgroundChannelStart + 0;
 
+static const int c_GroupChannel           = c_GroupStartChannel + 0;
+static const int c_NodeChannel            = c_NodeStartChannel  + 0;
+
 static const int c_UserChannel_Content         = c_UserLayerChannelStart + 1;
 static const int c_UserChannel_Grid            = c_UserLayerChannelStart + 2;
 static const int c_UserChannel_HintsBackground = c_UserLayerChannelStart + 3;
@@ -113,18 +123,29 @@ static const int c_LinkChannel_Links      = c_LinkStartChannel + 1;
 static const int c_LinkChannel_Flow       = c_LinkStartChannel + 2;
 static const int c_LinkChannel_NewLink    = c_LinkStartChannel + 3;
 
-static const int c_ChannelsPerNode           = 5;
-static const int c_NodeBaseChannel           = 0;
-static const int c_NodeBackgroundChannel     = 1;
-static const int c_NodeUserBackgroundChannel = 2;
-static const int c_NodePinChannel            = 3;
-static const int c_NodeContentChannel        = 4;
+static const int c_NodeLayer_Base           = 0;
+static const int c_NodeLayer_Background     = 1;
+static const int c_NodeLayer_UserBackground = 2;
+static const int c_NodeLayer_Pin            = 3;
+static const int c_NodeLayer_Content        = 4;
 
 static const float c_GroupSelectThickness       = 6.0f;  // canvas pixels
 static const float c_LinkSelectThickness        = 5.0f;  // canvas pixels
 static const float c_NavigationZoomMargin       = 0.1f;  // percentage of visible bounds
 static const float c_MouseZoomDuration          = 0.15f; // seconds
 static const float c_SelectionFadeOutDuration   = 0.15f; // seconds
+static const float c_GridSpacing                = 32.0f; // canvas pixels
+static const int   c_GridLevelFactor            = 4;     // lines of finer level per line of coarser one
+static const float c_GridMinLineSpacing         = 8.0f;  // screen pixels
+static const int   c_GridMaxLineCount           = 512;   // per axis
+static const int   c_MaxShapeTemplates          = 64;    // cache is dropped when full
+static const float c_ArcLengthTableStep         = 4.0f;  // canvas units between entries
+static const int   c_ArcLengthTableMaxSegments  = 256;
+static const float c_FrameCacheMargin           = 1.0f;  // view sizes captured on each side
+static const float c_FlowMarkerMinSpacing       = 8.0f;  // screen pixels, closer markers are thinned out
+static const int   c_FlowMarkerMaxThinning      = 16;    // power of two, at most that many markers merge into one
+static const float c_FlowMarkerMaxError         = 0.3f;  // screen pixels, circle tessellation
+static const float c_LinkBudgetMaxPointRatio    = 64.0f; // at most that many times fewer link points
 
 static const auto  c_MaxMoveOverEdgeSpeed       = 10.0f;
 static const auto  c_MaxMoveOverEdgeDistance    = 300.0f;
@@ -244,6 +265,34 @@ static void ImDrawList_SwapChannels(ImDrawList* drawList, int left, int right)
     ImDrawListSplitter_SwapChannels(&drawList->_Splitter, left, right);
 }
 
+static bool ImDrawCmd_HasSameHeader(const ImDrawCmd& lhs, const ImDrawCmd& rhs)
+{
+    return lhs.ClipRect.x == rhs.ClipRect.x && lhs.ClipRect.y == rhs.ClipRect.y
+        && lhs.ClipRect.z == rhs.ClipRect.z && lhs.ClipRect.w == rhs.ClipRect.w
+        && lhs.TextureId  == rhs.TextureId  && lhs.VtxOffset  == rhs.VtxOffset;
+}
+
+static void ImDrawChannel_AddCommand(ImDrawChannel& channel, const ImDrawCmd& command, const ImDrawIdx* indices, int indexCount)
+{
+    // Extend last command if possible, same as ImDrawListSplitter::Merge() does between channels
+    auto lastCommand = channel._CmdBuffer.Size > 0 ? &channel._CmdBuffer.back() : nullptr;
+    if (lastCommand && indexCount > 0 && lastCommand->UserCallback == nullptr && command.UserCallback == nullptr && ImDrawCmd_HasSameHeader(*lastCommand, command))
+    {
+        lastCommand->ElemCount += indexCount;
+    }
+    else
+    {
+        channel._CmdBuffer.push_back(command);
+        channel._CmdBuffer.back().IdxOffset = channel._IdxBuffer.Size;
+        channel._CmdBuffer.back().ElemCount = indexCount;
+    }
+
+    auto indexOffset = channel._IdxBuffer.Size;
+    channel._IdxBuffer.resize(indexOffset + indexCount);
+    if (indexCount > 0)
+        memcpy(channel._IdxBuffer.Data + indexOffset, indices, indexCount * sizeof(ImDrawIdx));
+}
+
 static void ImDrawList_SwapSplitter(ImDrawList* drawList, ImDrawListSplitter& splitter)
 {
     auto& currentSplitter = drawList->_Splitter;
@@ -343,18 +392,6 @@ static void ImDrawList_SwapSplitter(ImDrawList* drawList, ImDrawListSplitter& sp
 //        drawList->ChannelsSetCurrent(lastCurrentChannel);
 //}
 
-static void ImDrawList_PathBezierOffset(ImDrawList* drawList, float offset, const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3)
-{
-    using namespace ed;
-
-    auto acceptPoint = [drawList, offset](const ImCubicBezierSubdivideSample& r)
-    {
-        drawList->PathLineTo(r.Point + ImNormalized(ImVec2(-r.Tangent.y, r.Tangent.x)) * offset);
-    };
-
-    ImCubicBezierSubdivide(acceptPoint, p0, p1, p2, p3);
-}
-
 /*
 static void ImDrawList_PolyFillScanFlood(ImDrawList *draw, std::vector<ImVec2>* poly, ImColor color, int gap = 1, float strokeWidth = 1.0f)
 {
@@ -466,85 +503,6 @@ static void ImDrawList_PolyFillScanFlood(ImDrawList *draw, std::vector<ImVec2>*
 }
 */
 
-static void ImDrawList_AddBezierWithArrows(ImDrawList* drawList, const ImCubicBezierPoints& curve, float thickness,
-    float startArrowSize, float startArrowWidth, float endArrowSize, float endArrowWidth,
-    bool fill, ImU32 color, float strokeThickness, const ImVec2* startDirHint = nullptr, const ImVec2* endDirHint = nullptr)
-{
-    using namespace ax;
-
-    if ((color >> 24) == 0)
-        return;
-
-    const auto half_thickness = thickness * 0.5f;
-
-    if (fill)
-    {
-        drawList->AddBezierCubic(curve.P0, curve.P1, curve.P2, curve.P3, color, thickness);
-
-        if (startArrowSize > 0.0f)
-        {
-            const auto start_dir  = ImNormalized(startDirHint ? *startDirHint : ImCubicBezierTangent(curve.P0, curve.P1, curve.P2, curve.P3, 0.0f));
-            const auto start_n    = ImVec2(-start_dir.y, start_dir.x);
-            const auto half_width = startArrowWidth * 0.5f;
-            const auto tip        = curve.P0 - start_dir * startArrowSize;
-
-            drawList->PathLineTo(curve.P0 - start_n * ImMax(half_width, half_thickness));
-            drawList->PathLineTo(curve.P0 + start_n * ImMax(half_width, half_thickness));
-            drawList->PathLineTo(tip);
-            drawList->PathFillConvex(color);
-        }
-
-        if (endArrowSize > 0.0f)
-        {
-            const auto    end_dir = ImNormalized(endDirHint ? -*endDirHint : ImCubicBezierTangent(curve.P0, curve.P1, curve.P2, curve.P3, 1.0f));
-            const auto    end_n   = ImVec2(  -end_dir.y,   end_dir.x);
-            const auto half_width = endArrowWidth * 0.5f;
-            const auto tip        = curve.P3 + end_dir * endArrowSize;
-
-            drawList->PathLineTo(curve.P3 + end_n * ImMax(half_width, half_thickness));
-            drawList->PathLineTo(curve.P3 - end_n * ImMax(half_width, half_thickness));
-            drawList->PathLineTo(tip);
-            drawList->PathFillConvex(color);
-        }
-    }
-    else
-    {
-        if (startArrowSize > 0.0f)
-        {
-            const auto start_dir  = ImNormalized(ImCubicBezierTangent(curve.P0, curve.P1, curve.P2, curve.P3, 0.0f));
-            const auto start_n    = ImVec2(-start_dir.y, start_dir.x);
-            const auto half_width = startArrowWidth * 0.5f;
-            const auto tip        = curve.P0 - start_dir * startArrowSize;
-
-            if (half_width > half_thickness)
-                drawList->PathLineTo(curve.P0 - start_n * half_width);
-            drawList->PathLineTo(tip);
-            if (half_width > half_thickness)
-                drawList->PathLineTo(curve.P0 + start_n * half_width);
-        }
-
-        ImDrawList_PathBezierOffset(drawList, half_thickness, curve.P0, curve.P1, curve.P2, curve.P3);
-
-        if (endArrowSize > 0.0f)
-        {
-            const auto    end_dir = ImNormalized(ImCubicBezierTangent(curve.P0, curve.P1, curve.P2, curve.P3, 1.0f));
-            const auto    end_n   = ImVec2(  -end_dir.y,   end_dir.x);
-            const auto half_width = endArrowWidth * 0.5f;
-            const auto tip        = curve.P3 + end_dir * endArrowSize;
-
-            if (half_width > half_thickness)
-                drawList->PathLineTo(curve.P3 + end_n * half_width);
-            drawList->PathLineTo(tip);
-            if (half_width > half_thickness)
-                drawList->PathLineTo(curve.P3 - end_n * half_width);
-        }
-
-        ImDrawList_PathBezierOffset(drawList, half_thickness, curve.P3, curve.P2, curve.P1, curve.P0);
-
-        drawList->PathStroke(color, true, strokeThickness);
-    }
-}
-
 
 
 
@@ -553,20 +511,33 @@ static void ImDrawList_AddBezierWithArrows(ImDrawList* drawList, const ImCubicBe
 // Pin
 //
 //------------------------------------------------------------------------------
+ed::Pin::~Pin()
+{
+    Editor->RemovePinFromGrid(this);
+
+    while (m_FirstLink)
+        m_FirstLink->DetachFromPin(this);
+}
+
 void ed::Pin::Draw(ImDrawList* drawList, DrawFlags flags)
 {
     if (flags & Hovered)
     {
-        drawList->ChannelsSetCurrent(m_Node->m_Channel + c_NodePinChannel);
+        if (Editor->GetLevelOfDetail() == LevelOfDetail::Full)
+        {
+            Editor->SetNodeLayer(drawList, m_Node, c_NodeLayer_Pin);
 
-        drawList->AddRectFilled(m_Bounds.Min, m_Bounds.Max,
-            m_Color, m_Rounding, m_Corners);
+            auto& shapes = Editor->GetShapeCache();
 
-        if (m_BorderWidth > 0.0f)
-        {
-            FringeScaleScope fringe(1.0f);
-            drawList->AddRect(m_Bounds.Min, m_Bounds.Max,
-                m_BorderColor, m_Rounding, m_Corners, m_BorderWidth);
+            shapes.AddRectFilled(drawList, m_Bounds.Min, m_Bounds.Max,
+                m_Color, m_Rounding, m_Corners);
+
+            if (m_BorderWidth > 0.0f)
+            {
+                FringeScaleScope fringe(1.0f);
+                shapes.AddRect(drawList, m_Bounds.Min, m_Bounds.Max,
+                    m_BorderColor, m_Rounding, m_Corners, m_BorderWidth);
+            }
         }
 
         if (!Editor->IsSelected(m_Node))
@@ -624,6 +595,11 @@ ImLine ed::Pin::GetClosestLine(const Pin* pin) const
 // Node
 //
 //------------------------------------------------------------------------------
+ed::Node::~Node()
+{
+    Editor->RemoveNodeFromGrid(this);
+}
+
 bool ed::Node::AcceptDrag()
 {
     m_DragStart = m_Bounds.Min;
@@ -635,6 +611,7 @@ void ed::Node::UpdateDrag(const ImVec2& offset)
     auto size = m_Bounds.GetSize();
     m_Bounds.Min = ImFloor(m_DragStart + offset);
     m_Bounds.Max = m_Bounds.Min + size;
+    Editor->UpdateNodeGrid(this);
 }
 
 bool ed::Node::EndDrag()
@@ -646,25 +623,37 @@ void ed::Node::Draw(ImDrawList* drawList, DrawFlags flags)
 {
     if (flags == Detail::Object::None)
     {
-        drawList->ChannelsSetCurrent(m_Channel + c_NodeBackgroundChannel);
+        Editor->SetNodeLayer(drawList, this, c_NodeLayer_Background);
+
+        if (Editor->GetLevelOfDetail() == LevelOfDetail::Minimal)
+        {
+            drawList->AddRectFilled(m_Bounds.Min, m_Bounds.Max, m_Color);
+
+            if (IsGroup(this))
+                drawList->AddRectFilled(m_GroupBounds.Min, m_GroupBounds.Max, m_GroupColor);
+
+            return;
+        }
+
+        auto& shapes = Editor->GetShapeCache();
 
-        drawList->AddRectFilled(
+        shapes.AddRectFilled(drawList,
             m_Bounds.Min,
             m_Bounds.Max,
-            m_Color, m_Rounding);
+            m_Color, m_Rounding, c_AllRoundCornersFlags);
 
         if (IsGroup(this))
         {
-            drawList->AddRectFilled(
+            shapes.AddRectFilled(drawList,
                 m_GroupBounds.Min,
                 m_GroupBounds.Max,
-                m_GroupColor, m_GroupRounding);
+                m_GroupColor, m_GroupRounding, c_AllRoundCornersFlags);
 
             if (m_GroupBorderWidth > 0.0f)
             {
                 FringeScaleScope fringe(1.0f);
 
-                drawList->AddRect(
+                shapes.AddRect(drawList,
                     m_GroupBounds.Min,
                     m_GroupBounds.Max,
                     m_GroupBorderColor, m_GroupRounding, c_AllRoundCornersFlags, m_GroupBorderWidth);
@@ -698,7 +687,7 @@ void ed::Node::Draw(ImDrawList* drawList, DrawFlags flags)
         const auto  borderColor = Editor->GetColor(StyleColor_SelNodeBorder);
         const auto& editorStyle = Editor->GetStyle();
 
-        drawList->ChannelsSetCurrent(m_Channel + c_NodeBaseChannel);
+        Editor->SetNodeLayer(drawList, this, c_NodeLayer_Base);
 
         DrawBorder(drawList, borderColor, editorStyle.SelectedNodeBorderWidth, editorStyle.SelectedNodeBorderOffset);
     }
@@ -707,7 +696,7 @@ void ed::Node::Draw(ImDrawList* drawList, DrawFlags flags)
         const auto  borderColor = Editor->GetColor(StyleColor_HovNodeBorder);
         const auto& editorStyle = Editor->GetStyle();
 
-        drawList->ChannelsSetCurrent(m_Channel + c_NodeBaseChannel);
+        Editor->SetNodeLayer(drawList, this, c_NodeLayer_Base);
 
         DrawBorder(drawList, borderColor, editorStyle.HoveredNodeBorderWidth, editorStyle.HoverNodeBorderOffset);
     }
@@ -719,7 +708,7 @@ void ed::Node::DrawBorder(ImDrawList* drawList, ImU32 color, float thickness, fl
     {
         const ImVec2 extraOffset = ImVec2(offset, offset);
 
-        drawList->AddRect(m_Bounds.Min - extraOffset, m_Bounds.Max + extraOffset,
+        Editor->GetShapeCache().AddRect(drawList, m_Bounds.Min - extraOffset, m_Bounds.Max + extraOffset,
             color, ImMax(0.0f, m_Rounding + offset), c_AllRoundCornersFlags, thickness);
     }
 }
@@ -877,53 +866,147 @@ ed::NodeRegion ed::Node::GetRegion(const ImVec2& point) const
 // Link
 //
 //------------------------------------------------------------------------------
+ed::Link::~Link()
+{
+    if (m_FlowAnimation)
+        m_FlowAnimation->DetachLink();
+
+    Editor->RemoveLinkFromGrid(this);
+    DetachFromPins();
+}
+
+void ed::Link::AttachToPins(Pin* startPin, Pin* endPin)
+{
+    // Link looping back to the same pin is attached only once
+    if (endPin == startPin)
+        endPin = nullptr;
+
+    if (m_AttachedPin[0] == startPin && m_AttachedPin[1] == endPin)
+        return;
+
+    DetachFromPins();
+
+    if (startPin)
+        Attach(0, startPin);
+    if (endPin)
+        Attach(1, endPin);
+}
+
+void ed::Link::DetachFromPins()
+{
+    Detach(0);
+    Detach(1);
+}
+
+void ed::Link::DetachFromPin(Pin* pin)
+{
+    IM_ASSERT(m_AttachedPin[0] == pin || m_AttachedPin[1] == pin);
+
+    Detach(GetAttachedEnd(pin));
+}
+
+void ed::Link::Attach(int end, Pin* pin)
+{
+    auto first = pin->m_FirstLink;
+    if (first)
+        first->m_PrevAttached[first->GetAttachedEnd(pin)] = this;
+
+    m_AttachedPin[end]  = pin;
+    m_PrevAttached[end] = nullptr;
+    m_NextAttached[end] = first;
+    pin->m_FirstLink    = this;
+}
+
+void ed::Link::Detach(int end)
+{
+    auto pin = m_AttachedPin[end];
+    if (!pin)
+        return;
+
+    auto prev = m_PrevAttached[end];
+    auto next = m_NextAttached[end];
+
+    if (prev)
+        prev->m_NextAttached[prev->GetAttachedEnd(pin)] = next;
+    else
+        pin->m_FirstLink = next;
+
+    if (next)
+        next->m_PrevAttached[next->GetAttachedEnd(pin)] = prev;
+
+    m_AttachedPin[end]  = nullptr;
+    m_PrevAttached[end] = nullptr;
+    m_NextAttached[end] = nullptr;
+}
+
 void ed::Link::Draw(ImDrawList* drawList, DrawFlags flags)
 {
+    auto& linkBatcher = Editor->GetLinkBatcher();
+
     if (flags == None)
     {
-        drawList->ChannelsSetCurrent(c_LinkChannel_Links);
-
-        Draw(drawList, m_Color, 0.0f);
+        if (Editor->GetLevelOfDetail() == LevelOfDetail::Full)
+            DrawCached(drawList, m_Color);
+        else
+            linkBatcher.Add(c_LinkChannel_Links, this, m_Color, 0.0f);
     }
     else if (flags & Selected)
     {
         const auto borderColor = Editor->GetColor(StyleColor_SelLinkBorder);
 
-        drawList->ChannelsSetCurrent(c_LinkChannel_Selection);
-
-        Draw(drawList, borderColor, 4.5f);
+        linkBatcher.Add(c_LinkChannel_Selection, this, borderColor, 4.5f);
     }
     else if (flags & Hovered)
     {
         const auto borderColor = Editor->GetColor(StyleColor_HovLinkBorder);
 
-        drawList->ChannelsSetCurrent(c_LinkChannel_Selection);
-
-        Draw(drawList, borderColor, 2.0f);
+        linkBatcher.Add(c_LinkChannel_Selection, this, borderColor, 2.0f);
     }
     else if (flags & Highlighted)
     {
-        drawList->ChannelsSetCurrent(c_LinkChannel_Selection);
-
-        Draw(drawList, m_HighlightColor, 3.5f);
+        linkBatcher.Add(c_LinkChannel_Selection, this, m_HighlightColor, 3.5f);
     }
 }
 
 void ed::Link::Draw(ImDrawList* drawList, ImU32 color, float extraThickness) const
+{
+    auto& linkBatcher = Editor->GetLinkBatcher();
+
+    linkBatcher.Add(drawList->_Splitter._Current, this, color, extraThickness);
+    linkBatcher.Flush(drawList);
+}
+
+void ed::Link::DrawCached(ImDrawList* drawList, ImU32 color) const
 {
     if (!m_IsLive)
         return;
 
-    const auto curve = GetCurve();
+    DrawKey key;
+    key.Curve                = GetCurve();
+    key.Thickness            = m_Thickness;
+    key.StartArrowSize       = m_StartPin->m_ArrowSize;
+    key.StartArrowWidth      = m_StartPin->m_ArrowWidth;
+    key.EndArrowSize         = m_EndPin->m_ArrowSize;
+    key.EndArrowWidth        = m_EndPin->m_ArrowWidth;
+    key.StartDir             = m_StartPin->m_Dir;
+    key.EndDir               = m_EndPin->m_Dir;
+    key.SnapStartToDir       = m_StartPin->m_SnapLinkToDir;
+    key.SnapEndToDir         = m_EndPin->m_SnapLinkToDir;
+    key.Color                = color;
+    key.FringeScale          = ImFringeScaleRef(drawList);
+    key.CurveTessellationTol = drawList->_Data->CurveTessellationTol;
+    key.DrawListFlags        = drawList->Flags;
+    key.TexUvWhitePixel      = drawList->_Data->TexUvWhitePixel;
+    key.TextureId            = drawList->_CmdHeader.TextureId;
+
+    // Cache is filled by link batcher
+    if (!m_DrawCache.IsValid() || !(m_DrawKey == key))
+    {
+        m_DrawCache.Clear();
+        m_DrawKey = key;
+    }
 
-    ImDrawList_AddBezierWithArrows(drawList, curve, m_Thickness + extraThickness,
-        m_StartPin && m_StartPin->m_ArrowSize  > 0.0f ? m_StartPin->m_ArrowSize  + extraThickness : 0.0f,
-        m_StartPin && m_StartPin->m_ArrowWidth > 0.0f ? m_StartPin->m_ArrowWidth + extraThickness : 0.0f,
-          m_EndPin &&   m_EndPin->m_ArrowSize  > 0.0f ?   m_EndPin->m_ArrowSize  + extraThickness : 0.0f,
-          m_EndPin &&   m_EndPin->m_ArrowWidth > 0.0f ?   m_EndPin->m_ArrowWidth + extraThickness : 0.0f,
-        true, color, 1.0f,
-        m_StartPin && m_StartPin->m_SnapLinkToDir ? &m_StartPin->m_Dir : nullptr,
-        m_EndPin   &&   m_EndPin->m_SnapLinkToDir ?   &m_EndPin->m_Dir : nullptr);
+    Editor->GetLinkBatcher().Add(c_LinkChannel_Links, this, color, 0.0f, &m_DrawCache);
 }
 
 void ed::Link::UpdateEndpoints()
@@ -935,6 +1018,40 @@ void ed::Link::UpdateEndpoints()
 
 ImCubicBezierPoints ed::Link::GetCurve() const
 {
+    UpdateCurve();
+    return m_Curve;
+}
+
+const ed::ArcLengthTable& ed::Link::GetArcLengthTable() const
+{
+    UpdateCurve();
+
+    if (!m_ArcLength.IsValid())
+        m_ArcLength.Build(m_Curve);
+
+    return m_ArcLength;
+}
+
+void ed::Link::UpdateCurve() const
+{
+    CurveKey key;
+    key.Start          = m_Start;
+    key.End            = m_End;
+    key.StartDir       = m_StartPin->m_Dir;
+    key.EndDir         = m_EndPin->m_Dir;
+    key.StartStrength  = m_StartPin->m_Strength;
+    key.EndStrength    = m_EndPin->m_Strength;
+    key.StartArrowSize = m_StartPin->m_ArrowSize;
+    key.EndArrowSize   = m_EndPin->m_ArrowSize;
+
+    if (m_IsCurveValid && m_CurveKey == key)
+        return;
+
+    m_IsCurveValid = true;
+    m_CurveKey     = key;
+
+    m_ArcLength.Clear();
+
     auto easeLinkStrength = [](const ImVec2& a, const ImVec2& b, float strength)
     {
         const auto distanceX    = b.x - a.x;
@@ -953,13 +1070,49 @@ ImCubicBezierPoints ed::Link::GetCurve() const
     const auto           cp0 = m_Start + m_StartPin->m_Dir * startStrength;
     const auto           cp1 =   m_End +   m_EndPin->m_Dir *   endStrength;
 
-    ImCubicBezierPoints result;
-    result.P0 = m_Start;
-    result.P1 = cp0;
-    result.P2 = cp1;
-    result.P3 = m_End;
+    auto& curve = m_Curve;
+    curve.P0 = m_Start;
+    curve.P1 = cp0;
+    curve.P2 = cp1;
+    curve.P3 = m_End;
 
-    return result;
+    auto bounds = ImCubicBezierBoundingRect(curve.P0, curve.P1, curve.P2, curve.P3);
+
+    if (bounds.GetWidth() == 0.0f)
+    {
+        bounds.Min.x -= 0.5f;
+        bounds.Max.x += 0.5f;
+    }
+
+    if (bounds.GetHeight() == 0.0f)
+    {
+        bounds.Min.y -= 0.5f;
+        bounds.Max.y += 0.5f;
+    }
+
+    if (m_StartPin->m_ArrowSize)
+    {
+        const auto start_dir = ImNormalized(ImCubicBezierTangent(curve.P0, curve.P1, curve.P2, curve.P3, 0.0f));
+        const auto p0 = curve.P0;
+        const auto p1 = curve.P0 - start_dir * m_StartPin->m_ArrowSize;
+        const auto min = ImMin(p0, p1);
+        const auto max = ImMax(p0, p1);
+        auto arrowBounds = ImRect(min, ImMax(max, min + ImVec2(1, 1)));
+        bounds.Add(arrowBounds);
+    }
+
+    if (m_EndPin->m_ArrowSize)
+    {
+        const auto end_dir = ImNormalized(ImCubicBezierTangent(curve.P0, curve.P1, curve.P2, curve.P3, 1.0f));
+        const auto p0 = curve.P3;
+        const auto p1 = curve.P3 + end_dir * m_EndPin->m_ArrowSize;
+        const auto min = ImMin(p0, p1);
+        const auto max = ImMax(p0, p1);
+        auto arrowBounds = ImRect(min, ImMax(max, min + ImVec2(1, 1)));
+        bounds.Add(arrowBounds);
+    }
+
+    m_CurveBounds = bounds;
 }
 
 bool ed::Link::TestHit(const ImVec2& point, float extraThickness) const
@@ -975,9 +1128,8 @@ bool ed::Link::TestHit(const ImVec2& point, float extraThickness) const
         return false;
 
     const auto bezier = GetCurve();
-    const auto result = ImProjectOnCubicBezier(point, bezier.P0, bezier.P1, bezier.P2, bezier.P3, 50);
 
-    return result.Distance <= m_Thickness + extraThickness;
+    return ImCubicBezierIsPointNear(point, bezier, m_Thickness + extraThickness);
 }
 
 bool ed::Link::TestHit(const ImRect& rect, bool allowIntersect) const
@@ -995,68 +1147,16 @@ bool ed::Link::TestHit(const ImRect& rect, bool allowIntersect) const
 
     const auto bezier = GetCurve();
 
-    const auto p0 = rect.GetTL();
-    const auto p1 = rect.GetTR();
-    const auto p2 = rect.GetBR();
-    const auto p3 = rect.GetBL();
-
-    if (ImCubicBezierLineIntersect(bezier.P0, bezier.P1, bezier.P2, bezier.P3, p0, p1).Count > 0)
-        return true;
-    if (ImCubicBezierLineIntersect(bezier.P0, bezier.P1, bezier.P2, bezier.P3, p1, p2).Count > 0)
-        return true;
-    if (ImCubicBezierLineIntersect(bezier.P0, bezier.P1, bezier.P2, bezier.P3, p2, p3).Count > 0)
-        return true;
-    if (ImCubicBezierLineIntersect(bezier.P0, bezier.P1, bezier.P2, bezier.P3, p3, p0).Count > 0)
-        return true;
-
-    return false;
+    return ImCubicBezierRectIntersect(bezier, rect);
 }
 
 ImRect ed::Link::GetBounds() const
 {
-    if (m_IsLive)
-    {
-        const auto curve = GetCurve();
-        auto bounds = ImCubicBezierBoundingRect(curve.P0, curve.P1, curve.P2, curve.P3);
-
-        if (bounds.GetWidth() == 0.0f)
-        {
-            bounds.Min.x -= 0.5f;
-            bounds.Max.x += 0.5f;
-        }
-
-        if (bounds.GetHeight() == 0.0f)
-        {
-            bounds.Min.y -= 0.5f;
-            bounds.Max.y += 0.5f;
-        }
-
-        if (m_StartPin->m_ArrowSize)
-        {
-            const auto start_dir = ImNormalized(ImCubicBezierTangent(curve.P0, curve.P1, curve.P2, curve.P3, 0.0f));
-            const auto p0 = curve.P0;
-            const auto p1 = curve.P0 - start_dir * m_StartPin->m_ArrowSize;
-            const auto min = ImMin(p0, p1);
-            const auto max = ImMax(p0, p1);
-            auto arrowBounds = ImRect(min, ImMax(max, min + ImVec2(1, 1)));
-            bounds.Add(arrowBounds);
-        }
-
-        if (m_EndPin->m_ArrowSize)
-        {
-            const auto end_dir = ImNormalized(ImCubicBezierTangent(curve.P0, curve.P1, curve.P2, curve.P3, 1.0f));
-            const auto p0 = curve.P3;
-            const auto p1 = curve.P3 + end_dir * m_EndPin->m_ArrowSize;
-            const auto min = ImMin(p0, p1);
-            const auto max = ImMax(p0, p1);
-            auto arrowBounds = ImRect(min, ImMax(max, min + ImVec2(1, 1)));
-            bounds.Add(arrowBounds);
-        }
-
-        return bounds;
-    }
-    else
+    if (!m_IsLive)
         return ImRect();
+
+    UpdateCurve();
+    return m_CurveBounds;
 }
 
 
@@ -1064,120 +1164,1643 @@ ImRect ed::Link::GetBounds() const
 
 //------------------------------------------------------------------------------
 //
-// Editor Context
+// Draw Geometry Cache
 //
 //------------------------------------------------------------------------------
-ed::EditorContext::EditorContext(const ax::NodeEditor::Config* config)
-    : m_Config(config)
-    , m_EditorActiveId(0)
-    , m_IsFirstFrame(true)
-    , m_IsFocused(false)
-    , m_IsHovered(false)
-    , m_IsHoveredWithoutOverlapp(false)
-    , m_ShortcutsEnabled(true)
-    , m_Style()
-    , m_Nodes()
-    , m_Pins()
-    , m_Links()
-    , m_SelectionId(1)
-    , m_LastActiveLink(nullptr)
-    , m_Canvas()
-    , m_IsCanvasVisible(false)
-    , m_NodeBuilder(this)
-    , m_HintBuilder(this)
-    , m_CurrentAction(nullptr)
-    , m_NavigateAction(this, m_Canvas)
-    , m_SizeAction(this)
-    , m_DragAction(this)
-    , m_SelectAction(this)
-    , m_ContextMenuAction(this)
-    , m_ShortcutAction(this)
-    , m_CreateItemAction(this)
-    , m_DeleteItemsAction(this)
-    , m_AnimationControllers{ &m_FlowAnimationController }
-    , m_FlowAnimationController(this)
-    , m_HoveredNode(0)
-    , m_HoveredPin(0)
-    , m_HoveredLink(0)
-    , m_DoubleClickedNode(0)
-    , m_DoubleClickedPin(0)
-    , m_DoubleClickedLink(0)
-    , m_BackgroundClickButtonIndex(-1)
-    , m_BackgroundDoubleClickButtonIndex(-1)
-    , m_IsInitialized(false)
-    , m_Settings()
-    , m_DrawList(nullptr)
-    , m_ExternalChannel(0)
+void ed::DrawGeometryCache::Store(const ImDrawVert* vertices, int vertexCount, const ImDrawIdx* indices, int indexCount, unsigned int firstVertexIndex)
 {
+    m_Vertices.resize(vertexCount);
+    if (vertexCount > 0)
+        memcpy(m_Vertices.Data, vertices, vertexCount * sizeof(ImDrawVert));
+
+    m_Indices.resize(indexCount);
+    const auto base = static_cast<ImDrawIdx>(firstVertexIndex);
+    for (int i = 0; i < indexCount; ++i)
+        m_Indices[i] = static_cast<ImDrawIdx>(indices[i] - base);
+
+    m_IsValid = true;
 }
 
-ed::EditorContext::~EditorContext()
+void ed::DrawGeometryCache::Write(ImDrawVert* vertices, ImDrawIdx* indices, unsigned int firstVertexIndex) const
 {
-    if (m_IsInitialized)
-        SaveSettings();
+    IM_ASSERT(m_IsValid);
 
-    for (auto link  : m_Links)  delete link.m_Object;
-    for (auto pin   : m_Pins)   delete pin.m_Object;
-    for (auto node  : m_Nodes)  delete node.m_Object;
+    if (m_Vertices.Size > 0)
+        memcpy(vertices, m_Vertices.Data, m_Vertices.Size * sizeof(ImDrawVert));
 
-    m_Splitter.ClearFreeMemory();
+    const auto base = static_cast<ImDrawIdx>(firstVertexIndex);
+    for (int i = 0; i < m_Indices.Size; ++i)
+        indices[i] = static_cast<ImDrawIdx>(m_Indices[i] + base);
 }
 
-void ed::EditorContext::Begin(const char* id, const ImVec2& size)
+void ed::DrawGeometryCache::Clear()
 {
-    m_EditorActiveId = ImGui::GetID(id);
-    ImGui::PushID(id);
+    m_Vertices.clear();
+    m_Indices.clear();
+    m_IsValid = false;
+}
 
-    auto availableContentSize = ImGui::GetContentRegionAvail();
-    ImVec2 canvasSize = ImFloor(size);
-    if (canvasSize.x <= 0.0f)
-        canvasSize.x = ImMax(4.0f, availableContentSize.x);
-    if (canvasSize.y <= 0.0f)
-        canvasSize.y = ImMax(4.0f, availableContentSize.y);
 
-    if (!m_IsInitialized)
-    {
-        // Cycle canvas, so it has a chance to initialize its size before settings are loaded
-        if (m_Canvas.Begin(id, canvasSize))
-            m_Canvas.End();
 
-        LoadSettings();
-        m_IsInitialized = true;
-    }
 
-    //ImGui::LogToClipboard();
-    //Log("---- begin ----");
+//------------------------------------------------------------------------------
+//
+// Arc Length Table
+//
+//------------------------------------------------------------------------------
+void ed::ArcLengthTable::Build(const ImCubicBezierPoints& curve)
+{
+    m_Curve = curve;
 
-    static auto resetAndCollect = [](auto& objects)
-    {
-        objects.erase(std::remove_if(objects.begin(), objects.end(), [](auto objectWrapper)
-        {
-            if (objectWrapper->m_DeleteOnNewFrame)
-            {
-                delete objectWrapper.m_Object;
-                return true;
-            }
-            else
-            {
-                objectWrapper->Reset();
-                return false;
-            }
-        }), objects.end());
-    };
+    // Control polygon is never shorter than the curve, use it to pick resolution
+    const auto hullLength   = ImLength(curve.P1 - curve.P0) + ImLength(curve.P2 - curve.P1) + ImLength(curve.P3 - curve.P2);
+    const auto segmentCount = ImClamp(static_cast<int>(hullLength / c_ArcLengthTableStep), 8, c_ArcLengthTableMaxSegments);
 
-    resetAndCollect(m_Nodes);
-    resetAndCollect(m_Pins);
-    resetAndCollect(m_Links);
+    // Distance along the curve at uniform time steps, m_Times is borrowed
+    // for steps since it is filled only after distances are known
+    ImVector<float>  distances;
+    ImVector<ImVec2> points;
+    distances.resize(segmentCount + 1);
+    points.resize(segmentCount + 1);
+    m_Times.resize(segmentCount + 1);
 
-    m_DrawList = ImGui::GetWindowDrawList();
+    for (int i = 0; i <= segmentCount; ++i)
+        m_Times[i] = static_cast<float>(i) / segmentCount;
 
-    ImDrawList_SwapSplitter(m_DrawList, m_Splitter);
-    m_ExternalChannel = m_DrawList->_Splitter._Current;
+    ImCubicBezierN(&curve, 1, m_Times.Data, m_Times.Size, points.Data);
 
-    if (m_CurrentAction && m_CurrentAction->IsDragging() && m_NavigateAction.MoveOverEdge(canvasSize))
+    distances[0] = 0.0f;
+    for (int i = 1; i <= segmentCount; ++i)
+        distances[i] = distances[i - 1] + ImLength(points[i] - points[i - 1]);
+
+    m_Length = distances[segmentCount];
+
+    // Invert into time at uniform distance steps
+    int segment = 0;
+    for (int i = 0; i <= segmentCount; ++i)
     {
-        auto& io = ImGui::GetIO();
-        auto offset = m_NavigateAction.GetMoveScreenOffset();
+        const auto distance = m_Length * i / segmentCount;
+
+        while (segment + 1 < segmentCount && distances[segment + 1] < distance)
+            ++segment;
+
+        const auto span = distances[segment + 1] - distances[segment];
+        const auto u    = span > 0.0f ? ImSaturate((distance - distances[segment]) / span) : 0.0f;
+
+        m_Times[i] = (segment + u) / segmentCount;
+    }
+
+    m_Times[0]            = 0.0f;
+    m_Times[segmentCount] = 1.0f;
+
+    m_IsValid = true;
+}
+
+void ed::ArcLengthTable::Clear()
+{
+    m_Times.resize(0);
+    m_Length  = 0.0f;
+    m_IsValid = false;
+}
+
+float ed::ArcLengthTable::GetTime(float distance) const
+{
+    IM_ASSERT(m_IsValid);
+
+    if (m_Length <= 0.0f)
+        return 0.0f;
+
+    const auto x = ImSaturate(distance / m_Length) * (m_Times.Size - 1);
+    const auto i = ImMin(static_cast<int>(x), m_Times.Size - 2);
+
+    return ImLerp(m_Times[i], m_Times[i + 1], x - i);
+}
+
+ImVec2 ed::ArcLengthTable::SamplePoint(float distance) const
+{
+    return ImCubicBezierSample(m_Curve, GetTime(distance));
+}
+
+ImVec2 ed::ArcLengthTable::SampleTangent(float distance) const
+{
+    const auto tangent = ImCubicBezierTangent(m_Curve, GetTime(distance));
+    if (ImLengthSqr(tangent) > 0.0f)
+        return ImNormalized(tangent);
+
+    const auto chord = m_Curve.P3 - m_Curve.P0;
+    if (ImLengthSqr(chord) > 0.0f)
+        return ImNormalized(chord);
+
+    return ImVec2(1.0f, 0.0f);
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Shape Cache
+//
+//------------------------------------------------------------------------------
+void ed::ShapeCache::AddRectFilled(ImDrawList* drawList, const ImVec2& a, const ImVec2& b, ImU32 color, float rounding, int corners)
+{
+    Draw(drawList, a, b, color, Key{ rounding, corners, 0.0f, ImFringeScaleRef(drawList), drawList->Flags, drawList->_Data->TexUvWhitePixel });
+}
+
+void ed::ShapeCache::AddRect(ImDrawList* drawList, const ImVec2& a, const ImVec2& b, ImU32 color, float rounding, int corners, float thickness)
+{
+    Draw(drawList, a, b, color, Key{ rounding, corners, thickness, ImFringeScaleRef(drawList), drawList->Flags, drawList->_Data->TexUvWhitePixel });
+}
+
+void ed::ShapeCache::Clear()
+{
+    m_Templates.clear();
+}
+
+void ed::ShapeCache::Draw(ImDrawList* drawList, const ImVec2& a, const ImVec2& b, ImU32 color, const Key& key)
+{
+    if ((color & IM_COL32_A_MASK) == 0)
+        return;
+
+    auto tessellate = [&]()
+    {
+        if (key.Thickness > 0.0f)
+            drawList->AddRect(a, b, color, key.Rounding, key.Corners, key.Thickness);
+        else
+            drawList->AddRectFilled(a, b, color, key.Rounding, key.Corners);
+    };
+
+    // Corners must be joined by straight edges, otherwise vertices cannot
+    // be told apart and ImGui clamps rounding to the size of rectangle.
+    const auto minSize = 2.0f * (key.Rounding + key.Thickness + key.FringeScale) + 2.0f;
+    if (b.x - a.x < minSize || b.y - a.y < minSize)
+    {
+        tessellate();
+        return;
+    }
+
+    const ImVec2 anchors[4] = { a, ImVec2(b.x, a.y), ImVec2(a.x, b.y), b };
+
+    auto shape = std::find_if(m_Templates.begin(), m_Templates.end(), [&key](const Template& shape) { return shape.m_Key == key; });
+    if (shape == m_Templates.end())
+    {
+        const auto vtxStart      = drawList->VtxBuffer.Size;
+        const auto idxStart      = drawList->IdxBuffer.Size;
+        const auto vtxIndexStart = drawList->_VtxCurrentIdx;
+        const auto vtxOffset     = drawList->_CmdHeader.VtxOffset;
+
+        tessellate();
+
+        // Geometry crossing vertex offset cannot be captured with single base index
+        if (drawList->_CmdHeader.VtxOffset != vtxOffset)
+            return;
+
+        if (static_cast<int>(m_Templates.size()) >= c_MaxShapeTemplates)
+            m_Templates.clear();
+
+        m_Templates.push_back(Template());
+
+        auto& capture = m_Templates.back();
+        capture.m_Key = key;
+
+        const auto vtxCount = drawList->VtxBuffer.Size - vtxStart;
+        const auto idxCount = drawList->IdxBuffer.Size - idxStart;
+        const auto center   = (a + b) * 0.5f;
+
+        capture.m_Vertices.resize(vtxCount);
+        capture.m_Corners.resize(vtxCount);
+        for (int i = 0; i < vtxCount; ++i)
+        {
+            auto       vertex = drawList->VtxBuffer[vtxStart + i];
+            const auto corner = static_cast<ImU8>((vertex.pos.x > center.x ? 1 : 0) | (vertex.pos.y > center.y ? 2 : 0));
+
+            vertex.pos -= anchors[corner];
+            vertex.col &= IM_COL32_A_MASK;
+
+            capture.m_Vertices[i] = vertex;
+            capture.m_Corners[i]  = corner;
+        }
+
+        capture.m_Indices.resize(idxCount);
+        for (int i = 0; i < idxCount; ++i)
+            capture.m_Indices[i] = static_cast<ImDrawIdx>(drawList->IdxBuffer[idxStart + i] - vtxIndexStart);
+
+        return;
+    }
+
+    // Anti-aliased fringe fades to transparent version of the same color
+    const auto colorTrans = color & ~IM_COL32_A_MASK;
+    const auto vtxCount   = shape->m_Vertices.Size;
+    const auto idxCount   = shape->m_Indices.Size;
+
+    drawList->PrimReserve(idxCount, vtxCount);
+
+    const auto base = drawList->_VtxCurrentIdx;
+
+    auto vtx = drawList->_VtxWritePtr;
+    for (int i = 0; i < vtxCount; ++i, ++vtx)
+    {
+        const auto& vertex = shape->m_Vertices[i];
+        vtx->pos = vertex.pos + anchors[shape->m_Corners[i]];
+        vtx->uv  = vertex.uv;
+        vtx->col = vertex.col ? color : colorTrans;
+    }
+
+    auto idx = drawList->_IdxWritePtr;
+    for (int i = 0; i < idxCount; ++i)
+        idx[i] = static_cast<ImDrawIdx>(shape->m_Indices[i] + base);
+
+    drawList->_VtxWritePtr   += vtxCount;
+    drawList->_IdxWritePtr   += idxCount;
+    drawList->_VtxCurrentIdx += vtxCount;
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Node Content Cache
+//
+//------------------------------------------------------------------------------
+ed::NodeContentCache::Mark ed::NodeContentCache::Begin(ImDrawList* drawList)
+{
+    Mark mark;
+    mark.m_VtxStart      = drawList->VtxBuffer.Size;
+    mark.m_IdxStart      = drawList->IdxBuffer.Size;
+    mark.m_VtxIndexStart = drawList->_VtxCurrentIdx;
+    mark.m_VtxOffset     = drawList->_CmdHeader.VtxOffset;
+    mark.m_ClipRect      = drawList->_CmdHeader.ClipRect;
+    return mark;
+}
+
+bool ed::NodeContentCache::Store(ImDrawList* drawList, const Mark& mark, const ImVec2& origin)
+{
+    m_Commands.resize(0);
+    m_IsValid = false;
+
+    // Content crossing vertex offset cannot be replayed with single base index
+    if (drawList->_CmdHeader.VtxOffset != mark.m_VtxOffset)
+        return false;
+
+    const auto vtxCount = drawList->VtxBuffer.Size - mark.m_VtxStart;
+    const auto idxCount = drawList->IdxBuffer.Size - mark.m_IdxStart;
+
+    // Commands are in drawing order, find first one reaching into recorded indices
+    int commandIndex = drawList->CmdBuffer.Size;
+    while (commandIndex > 0 && static_cast<int>(drawList->CmdBuffer[commandIndex - 1].IdxOffset + drawList->CmdBuffer[commandIndex - 1].ElemCount) > mark.m_IdxStart)
+        --commandIndex;
+
+    for (; commandIndex < drawList->CmdBuffer.Size; ++commandIndex)
+    {
+        const auto& command = drawList->CmdBuffer[commandIndex];
+        if (command.UserCallback != nullptr || command.VtxOffset != mark.m_VtxOffset)
+        {
+            Clear();
+            return false;
+        }
+
+        const auto idxStart = ImMax(static_cast<int>(command.IdxOffset), mark.m_IdxStart);
+        const auto idxEnd   = static_cast<int>(command.IdxOffset + command.ElemCount);
+        if (idxStart >= idxEnd)
+            continue;
+
+        m_Commands.push_back({ command.ClipRect, command.TextureId, idxStart - mark.m_IdxStart, idxEnd - idxStart });
+    }
+
+    m_Indices.resize(idxCount);
+    for (int i = 0; i < idxCount; ++i)
+    {
+        const auto index = static_cast<int>(drawList->IdxBuffer[mark.m_IdxStart + i]) - static_cast<int>(mark.m_VtxIndexStart);
+        if (index < 0 || index >= vtxCount)
+        {
+            Clear();
+            return false;
+        }
+
+        m_Indices[i] = static_cast<ImDrawIdx>(index);
+    }
+
+    m_Vertices.resize(vtxCount);
+    if (vtxCount > 0)
+        memcpy(m_Vertices.Data, drawList->VtxBuffer.Data + mark.m_VtxStart, vtxCount * sizeof(ImDrawVert));
+
+    m_Origin          = origin;
+    m_ClipRect        = mark.m_ClipRect;
+    m_Font            = drawList->_Data->Font;
+    m_FontSize        = drawList->_Data->FontSize;
+    m_FringeScale     = ImFringeScaleRef(drawList);
+    m_Flags           = drawList->Flags;
+    m_TexUvWhitePixel = drawList->_Data->TexUvWhitePixel;
+    m_IsValid         = true;
+
+    return true;
+}
+
+void ed::NodeContentCache::Replay(ImDrawList* drawList, const ImVec2& origin) const
+{
+    IM_ASSERT(m_IsValid);
+
+    if (m_Commands.empty())
+        return;
+
+    const auto offset   = origin - m_Origin;
+    const auto clipRect = drawList->_CmdHeader.ClipRect;
+
+    drawList->PrimReserve(0, m_Vertices.Size);
+
+    const auto vtxIndexStart = drawList->_VtxCurrentIdx;
+
+    auto vtx = drawList->_VtxWritePtr;
+    for (const auto& vertex : m_Vertices)
+    {
+        *vtx = vertex;
+        vtx->pos += offset;
+        ++vtx;
+    }
+
+    drawList->_VtxWritePtr    = vtx;
+    drawList->_VtxCurrentIdx += m_Vertices.Size;
+
+    const auto base = static_cast<ImDrawIdx>(vtxIndexStart);
+    for (const auto& command : m_Commands)
+    {
+        auto commandClipRect = clipRect;
+        if (command.m_ClipRect.x != m_ClipRect.x || command.m_ClipRect.y != m_ClipRect.y
+         || command.m_ClipRect.z != m_ClipRect.z || command.m_ClipRect.w != m_ClipRect.w)
+        {
+            // Clipped by user, follow the node but stay in current clip rectangle
+            commandClipRect.x = ImMax(command.m_ClipRect.x + offset.x, clipRect.x);
+            commandClipRect.y = ImMax(command.m_ClipRect.y + offset.y, clipRect.y);
+            commandClipRect.z = ImMin(command.m_ClipRect.z + offset.x, clipRect.z);
+            commandClipRect.w = ImMin(command.m_ClipRect.w + offset.y, clipRect.w);
+        }
+
+        drawList->PushClipRect(ImVec2(commandClipRect.x, commandClipRect.y), ImVec2(commandClipRect.z, commandClipRect.w));
+        drawList->PushTextureID(command.m_TextureId);
+
+        drawList->PrimReserve(command.m_IdxCount, 0);
+
+        auto idx = drawList->_IdxWritePtr;
+        for (int i = 0; i < command.m_IdxCount; ++i)
+            idx[i] = static_cast<ImDrawIdx>(m_Indices[command.m_IdxStart + i] + base);
+        drawList->_IdxWritePtr += command.m_IdxCount;
+
+        drawList->PopTextureID();
+        drawList->PopClipRect();
+    }
+}
+
+void ed::NodeContentCache::Clear()
+{
+    m_Vertices.clear();
+    m_Indices.clear();
+    m_Commands.clear();
+    m_IsValid = false;
+}
+
+bool ed::NodeContentCache::IsValid(ImDrawList* drawList) const
+{
+    return m_IsValid
+        && m_Font            == drawList->_Data->Font
+        && m_FontSize        == drawList->_Data->FontSize
+        && m_FringeScale     == ImFringeScaleRef(drawList)
+        && m_Flags           == drawList->Flags
+        && m_TexUvWhitePixel == drawList->_Data->TexUvWhitePixel;
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Link Batcher
+//
+//------------------------------------------------------------------------------
+// Same as IM_NORMALIZE2F_OVER_ZERO and IM_FIXNORMAL2F in imgui_draw.cpp.
+static inline void ImNormalize2fOverZero(float& x, float& y)
+{
+    const float d2 = x * x + y * y;
+    if (d2 > 0.0f)
+    {
+        const float invLength = ImRsqrt(d2);
+        x *= invLength;
+        y *= invLength;
+    }
+}
+
+static inline void ImFixNormal2f(float& x, float& y)
+{
+    const float d2 = x * x + y * y;
+    if (d2 > 0.000001f)
+    {
+        float invLength2 = 1.0f / d2;
+        if (invLength2 > 100.0f)
+            invLength2 = 100.0f;
+        x *= invLength2;
+        y *= invLength2;
+    }
+}
+
+// Appends points of the curve without the first one. Subdivision is the same
+// ImCubicBezierSubdivide() does, flatness test also catches links going back
+// along the chord.
+static void ImCubicBezierTessellate(std::vector<ImVec2>& points, const ImCubicBezierPoints& curve, float tessellationTolerance)
+{
+    // Flatness of both halves is tested at once when piece is split
+    struct Segment
+    {
+        ImCubicBezierPoints curve;
+        int                 level;
+        bool                isFlat;
+    };
+
+    const int c_MaxLevel = 10;
+
+    Segment stack[c_MaxLevel + 2];
+    int     stackSize = 0;
+
+    stack[stackSize++] = Segment{ curve, 0, (ImCubicBezierIsFlat2(curve, curve, tessellationTolerance) & 1) != 0 };
+
+    while (stackSize > 0)
+    {
+        const auto  s = stack[--stackSize];
+        const auto& c = s.curve;
+
+        // Piece which is still not flat at last level is taken as is, instead
+        // of being dropped
+        if (s.level >= c_MaxLevel || s.isFlat)
+        {
+            points.push_back(c.P3);
+        }
+        else
+        {
+            const auto p12   = (c.P0 + c.P1) * 0.5f;
+            const auto p23   = (c.P1 + c.P2) * 0.5f;
+            const auto p34   = (c.P2 + c.P3) * 0.5f;
+            const auto p123  = (p12 + p23) * 0.5f;
+            const auto p234  = (p23 + p34) * 0.5f;
+            const auto p1234 = (p123 + p234) * 0.5f;
+
+            const auto left   = ImCubicBezierPoints{ c.P0, p12, p123, p1234 };
+            const auto right  = ImCubicBezierPoints{ p1234, p234, p34, c.P3 };
+            const auto isFlat = ImCubicBezierIsFlat2(left, right, tessellationTolerance);
+
+            // Second half is pushed first, so first half is processed first
+            stack[stackSize++] = Segment{ right, s.level + 1, (isFlat & 2) != 0 };
+            stack[stackSize++] = Segment{ left,  s.level + 1, (isFlat & 1) != 0 };
+        }
+    }
+}
+
+enum class LinkStroke { Aliased, Thin, Thick, Textured };
+
+// Picks the same stroke ImDrawList::AddPolyline() would use.
+static LinkStroke ImDrawList_GetLinkStroke(ImDrawList* drawList, float thickness)
+{
+    if (!(drawList->Flags & ImDrawListFlags_AntiAliasedLines))
+        return LinkStroke::Aliased;
+
+    const auto fringeScale = ed::ImFringeScaleRef(drawList);
+    const auto isThick     = thickness > fringeScale;
+
+    thickness = ImMax(thickness, 1.0f);
+    const auto integerThickness    = static_cast<int>(thickness);
+    const auto fractionalThickness = thickness - integerThickness;
+
+    if ((drawList->Flags & ImDrawListFlags_AntiAliasedLinesUseTex) && integerThickness < IM_DRAWLIST_TEX_LINES_WIDTH_MAX && fractionalThickness <= 0.00001f && fringeScale == 1.0f)
+        return LinkStroke::Textured;
+
+    return isThick ? LinkStroke::Thick : LinkStroke::Thin;
+}
+
+static void ImDrawList_GetPolylineSize(ImDrawList* drawList, int pointCount, float thickness, int& vtxCount, int& idxCount)
+{
+    if (pointCount < 2)
+    {
+        vtxCount = 0;
+        idxCount = 0;
+        return;
+    }
+
+    const auto segmentCount = pointCount - 1;
+    switch (ImDrawList_GetLinkStroke(drawList, thickness))
+    {
+        case LinkStroke::Aliased:  vtxCount = segmentCount * 4; idxCount = segmentCount * 6;  break;
+        case LinkStroke::Thin:     vtxCount = pointCount   * 3; idxCount = segmentCount * 12; break;
+        case LinkStroke::Thick:    vtxCount = pointCount   * 4; idxCount = segmentCount * 18; break;
+        case LinkStroke::Textured: vtxCount = pointCount   * 2; idxCount = segmentCount * 6;  break;
+    }
+}
+
+static void ImDrawList_GetTriangleSize(ImDrawList* drawList, int& vtxCount, int& idxCount)
+{
+    const auto isAntiAliased = (drawList->Flags & ImDrawListFlags_AntiAliasedFill) != 0;
+
+    vtxCount = isAntiAliased ? 6 : 3;
+    idxCount = isAntiAliased ? 3 + 3 * 6 : 3;
+}
+
+// Writes open polyline into reserved memory, output matches ImDrawList::AddPolyline().
+static void ImDrawList_WritePolyline(ImDrawList* drawList, const ImVec2* points, int pointCount, ImU32 col, float thickness, ImVec2* normals,
+    ImDrawVert*& vtx, ImDrawIdx*& idx, unsigned int& vtxIndex)
+{
+    if (pointCount < 2)
+        return;
+
+    const auto stroke       = ImDrawList_GetLinkStroke(drawList, thickness);
+    const auto opaqueUv     = drawList->_Data->TexUvWhitePixel;
+    const auto segmentCount = pointCount - 1;
+
+    if (stroke == LinkStroke::Aliased)
+    {
+        for (int i1 = 0; i1 < segmentCount; ++i1)
+        {
+            const auto& p1 = points[i1];
+            const auto& p2 = points[i1 + 1];
+
+            float dx = p2.x - p1.x;
+            float dy = p2.y - p1.y;
+            ImNormalize2fOverZero(dx, dy);
+            dx *= (thickness * 0.5f);
+            dy *= (thickness * 0.5f);
+
+            vtx[0].pos.x = p1.x + dy; vtx[0].pos.y = p1.y - dx; vtx[0].uv = opaqueUv; vtx[0].col = col;
+            vtx[1].pos.x = p2.x + dy; vtx[1].pos.y = p2.y - dx; vtx[1].uv = opaqueUv; vtx[1].col = col;
+            vtx[2].pos.x = p2.x - dy; vtx[2].pos.y = p2.y + dx; vtx[2].uv = opaqueUv; vtx[2].col = col;
+            vtx[3].pos.x = p1.x - dy; vtx[3].pos.y = p1.y + dx; vtx[3].uv = opaqueUv; vtx[3].col = col;
+            vtx += 4;
+
+            idx[0] = (ImDrawIdx)(vtxIndex); idx[1] = (ImDrawIdx)(vtxIndex + 1); idx[2] = (ImDrawIdx)(vtxIndex + 2);
+            idx[3] = (ImDrawIdx)(vtxIndex); idx[4] = (ImDrawIdx)(vtxIndex + 2); idx[5] = (ImDrawIdx)(vtxIndex + 3);
+            idx += 6;
+
+            vtxIndex += 4;
+        }
+
+        return;
+    }
+
+    const auto aaSize   = ed::ImFringeScaleRef(drawList);
+    const auto colTrans = col & ~IM_COL32_A_MASK;
+
+    thickness = ImMax(thickness, 1.0f);
+
+    for (int i1 = 0; i1 < segmentCount; ++i1)
+    {
+        float dx = points[i1 + 1].x - points[i1].x;
+        float dy = points[i1 + 1].y - points[i1].y;
+        ImNormalize2fOverZero(dx, dy);
+        normals[i1].x = dy;
+        normals[i1].y = -dx;
+    }
+    normals[pointCount - 1] = normals[pointCount - 2];
+
+    // Offset of the point edges along averaged normal, first point uses
+    // normal of the first segment.
+    auto pointNormal = [normals](int i, float& x, float& y)
+    {
+        if (i == 0)
+        {
+            x = normals[0].x;
+            y = normals[0].y;
+            return;
+        }
+
+        x = (normals[i - 1].x + normals[i].x) * 0.5f;
+        y = (normals[i - 1].y + normals[i].y) * 0.5f;
+        ImFixNormal2f(x, y);
+    };
+
+    if (stroke == LinkStroke::Thick)
+    {
+        const auto halfInnerThickness = (thickness - aaSize) * 0.5f;
+
+        unsigned int idx1 = vtxIndex;
+        for (int i1 = 0; i1 < segmentCount; ++i1)
+        {
+            const unsigned int idx2 = idx1 + 4;
+
+            idx[0]  = (ImDrawIdx)(idx2 + 1); idx[1]  = (ImDrawIdx)(idx1 + 1); idx[2]  = (ImDrawIdx)(idx1 + 2);
+            idx[3]  = (ImDrawIdx)(idx1 + 2); idx[4]  = (ImDrawIdx)(idx2 + 2); idx[5]  = (ImDrawIdx)(idx2 + 1);
+            idx[6]  = (ImDrawIdx)(idx2 + 1); idx[7]  = (ImDrawIdx)(idx1 + 1); idx[8]  = (ImDrawIdx)(idx1 + 0);
+            idx[9]  = (ImDrawIdx)(idx1 + 0); idx[10] = (ImDrawIdx)(idx2 + 0); idx[11] = (ImDrawIdx)(idx2 + 1);
+            idx[12] = (ImDrawIdx)(idx2 + 2); idx[13] = (ImDrawIdx)(idx1 + 2); idx[14] = (ImDrawIdx)(idx1 + 3);
+            idx[15] = (ImDrawIdx)(idx1 + 3); idx[16] = (ImDrawIdx)(idx2 + 3); idx[17] = (ImDrawIdx)(idx2 + 2);
+            idx += 18;
+
+            idx1 = idx2;
+        }
+
+        for (int i = 0; i < pointCount; ++i)
+        {
+            float dmX, dmY;
+            pointNormal(i, dmX, dmY);
+
+            const float dmOutX = dmX * (halfInnerThickness + aaSize);
+            const float dmOutY = dmY * (halfInnerThickness + aaSize);
+            const float dmInX  = dmX * halfInnerThickness;
+            const float dmInY  = dmY * halfInnerThickness;
+
+            const auto& p = points[i];
+            vtx[0].pos.x = p.x + dmOutX; vtx[0].pos.y = p.y + dmOutY; vtx[0].uv = opaqueUv; vtx[0].col = colTrans;
+            vtx[1].pos.x = p.x + dmInX;  vtx[1].pos.y = p.y + dmInY;  vtx[1].uv = opaqueUv; vtx[1].col = col;
+            vtx[2].pos.x = p.x - dmInX;  vtx[2].pos.y = p.y - dmInY;  vtx[2].uv = opaqueUv; vtx[2].col = col;
+            vtx[3].pos.x = p.x - dmOutX; vtx[3].pos.y = p.y - dmOutY; vtx[3].uv = opaqueUv; vtx[3].col = colTrans;
+            vtx += 4;
+        }
+
+        vtxIndex += pointCount * 4;
+    }
+    else
+    {
+        const auto isTextured   = stroke == LinkStroke::Textured;
+        const auto halfDrawSize = isTextured ? ((thickness * 0.5f) + 1) : aaSize;
+        const auto stride       = isTextured ? 2u : 3u;
+
+        unsigned int idx1 = vtxIndex;
+        for (int i1 = 0; i1 < segmentCount; ++i1)
+        {
+            const unsigned int idx2 = idx1 + stride;
+
+            if (isTextured)
+            {
+                idx[0] = (ImDrawIdx)(idx2 + 0); idx[1] = (ImDrawIdx)(idx1 + 0); idx[2] = (ImDrawIdx)(idx1 + 1);
+                idx[3] = (ImDrawIdx)(idx2 + 1); idx[4] = (ImDrawIdx)(idx1 + 1); idx[5] = (ImDrawIdx)(idx2 + 0);
+                idx += 6;
+            }
+            else
+            {
+                idx[0] = (ImDrawIdx)(idx2 + 0); idx[1]  = (ImDrawIdx)(idx1 + 0); idx[2]  = (ImDrawIdx)(idx1 + 2);
+                idx[3] = (ImDrawIdx)(idx1 + 2); idx[4]  = (ImDrawIdx)(idx2 + 2); idx[5]  = (ImDrawIdx)(idx2 + 0);
+                idx[6] = (ImDrawIdx)(idx2 + 1); idx[7]  = (ImDrawIdx)(idx1 + 1); idx[8]  = (ImDrawIdx)(idx1 + 0);
+                idx[9] = (ImDrawIdx)(idx1 + 0); idx[10] = (ImDrawIdx)(idx2 + 0); idx[11] = (ImDrawIdx)(idx2 + 1);
+                idx += 12;
+            }
+
+            idx1 = idx2;
+        }
+
+        const auto texUvs = isTextured ? drawList->_Data->TexUvLines[static_cast<int>(thickness)] : ImVec4();
+        const auto texUv0 = ImVec2(texUvs.x, texUvs.y);
+        const auto texUv1 = ImVec2(texUvs.z, texUvs.w);
+
+        for (int i = 0; i < pointCount; ++i)
+        {
+            float dmX, dmY;
+            pointNormal(i, dmX, dmY);
+            dmX *= halfDrawSize;
+            dmY *= halfDrawSize;
+
+            const auto& p = points[i];
+            if (isTextured)
+            {
+                vtx[0].pos.x = p.x + dmX; vtx[0].pos.y = p.y + dmY; vtx[0].uv = texUv0; vtx[0].col = col;
+                vtx[1].pos.x = p.x - dmX; vtx[1].pos.y = p.y - dmY; vtx[1].uv = texUv1; vtx[1].col = col;
+                vtx += 2;
+            }
+            else
+            {
+                vtx[0].pos   = p;                                       vtx[0].uv = opaqueUv; vtx[0].col = col;
+                vtx[1].pos.x = p.x + dmX; vtx[1].pos.y = p.y + dmY; vtx[1].uv = opaqueUv; vtx[1].col = colTrans;
+                vtx[2].pos.x = p.x - dmX; vtx[2].pos.y = p.y - dmY; vtx[2].uv = opaqueUv; vtx[2].col = colTrans;
+                vtx += 3;
+            }
+        }
+
+        vtxIndex += pointCount * stride;
+    }
+}
+
+// Writes filled triangle into reserved memory, output matches ImDrawList::AddConvexPolyFilled().
+static void ImDrawList_WriteTriangle(ImDrawList* drawList, const ImVec2 (&points)[3], ImU32 col,
+    ImDrawVert*& vtx, ImDrawIdx*& idx, unsigned int& vtxIndex)
+{
+    const auto uv = drawList->_Data->TexUvWhitePixel;
+
+    if (!(drawList->Flags & ImDrawListFlags_AntiAliasedFill))
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            vtx[i].pos = points[i]; vtx[i].uv = uv; vtx[i].col = col;
+        }
+        vtx += 3;
+
+        idx[0] = (ImDrawIdx)(vtxIndex); idx[1] = (ImDrawIdx)(vtxIndex + 1); idx[2] = (ImDrawIdx)(vtxIndex + 2);
+        idx += 3;
+
+        vtxIndex += 3;
+        return;
+    }
+
+    const auto aaSize   = ed::ImFringeScaleRef(drawList);
+    const auto colTrans = col & ~IM_COL32_A_MASK;
+
+    const unsigned int innerIdx = vtxIndex;
+    const unsigned int outerIdx = vtxIndex + 1;
+
+    idx[0] = (ImDrawIdx)(innerIdx); idx[1] = (ImDrawIdx)(innerIdx + 2); idx[2] = (ImDrawIdx)(innerIdx + 4);
+    idx += 3;
+
+    ImVec2 normals[3];
+    for (int i0 = 2, i1 = 0; i1 < 3; i0 = i1++)
+    {
+        float dx = points[i1].x - points[i0].x;
+        float dy = points[i1].y - points[i0].y;
+        ImNormalize2fOverZero(dx, dy);
+        normals[i0].x = dy;
+        normals[i0].y = -dx;
+    }
+
+    for (int i0 = 2, i1 = 0; i1 < 3; i0 = i1++)
+    {
+        float dmX = (normals[i0].x + normals[i1].x) * 0.5f;
+        float dmY = (normals[i0].y + normals[i1].y) * 0.5f;
+        ImFixNormal2f(dmX, dmY);
+        dmX *= aaSize * 0.5f;
+        dmY *= aaSize * 0.5f;
+
+        vtx[0].pos.x = (points[i1].x - dmX); vtx[0].pos.y = (points[i1].y - dmY); vtx[0].uv = uv; vtx[0].col = col;
+        vtx[1].pos.x = (points[i1].x + dmX); vtx[1].pos.y = (points[i1].y + dmY); vtx[1].uv = uv; vtx[1].col = colTrans;
+        vtx += 2;
+
+        idx[0] = (ImDrawIdx)(innerIdx + (i1 << 1)); idx[1] = (ImDrawIdx)(innerIdx + (i0 << 1)); idx[2] = (ImDrawIdx)(outerIdx + (i0 << 1));
+        idx[3] = (ImDrawIdx)(outerIdx + (i0 << 1)); idx[4] = (ImDrawIdx)(outerIdx + (i1 << 1)); idx[5] = (ImDrawIdx)(innerIdx + (i1 << 1));
+        idx += 6;
+    }
+
+    vtxIndex += 6;
+}
+
+void ed::LinkBatcher::Begin(float tessellationTolerance, int pointBudget)
+{
+    m_TessellationTolerance = tessellationTolerance;
+    m_PointBudget           = pointBudget;
+    m_LastPointCount        = m_PointCount;
+    m_PointCount            = 0;
+
+    m_Items.resize(0);
+    m_Points.resize(0);
+}
+
+void ed::LinkBatcher::Add(int channel, const Link* link, ImU32 color, float extraThickness, DrawGeometryCache* cache)
+{
+    if (!link->m_IsLive || (color & IM_COL32_A_MASK) == 0)
+        return;
+
+    const auto startPin = link->m_StartPin;
+    const auto endPin   = link->m_EndPin;
+
+    Item item;
+    item.m_Curve           = link->GetCurve();
+    item.m_Thickness       = link->m_Thickness + extraThickness;
+    item.m_StartArrowSize  = startPin && startPin->m_ArrowSize  > 0.0f ? startPin->m_ArrowSize  + extraThickness : 0.0f;
+    item.m_StartArrowWidth = startPin && startPin->m_ArrowWidth > 0.0f ? startPin->m_ArrowWidth + extraThickness : 0.0f;
+    item.m_EndArrowSize    =   endPin &&   endPin->m_ArrowSize  > 0.0f ?   endPin->m_ArrowSize  + extraThickness : 0.0f;
+    item.m_EndArrowWidth   =   endPin &&   endPin->m_ArrowWidth > 0.0f ?   endPin->m_ArrowWidth + extraThickness : 0.0f;
+    item.m_IsStraight      = link->Editor->GetLevelOfDetail() != LevelOfDetail::Full;
+    item.m_Color           = color;
+    item.m_Channel         = channel;
+    item.m_Cache           = cache;
+    item.m_Replay          = cache && cache->IsValid();
+    item.m_PointStart      = 0;
+    item.m_PointCount      = 0;
+    item.m_VtxCount        = 0;
+    item.m_IdxCount        = 0;
+
+    const auto& curve = item.m_Curve;
+    if (item.m_StartArrowSize > 0.0f)
+        item.m_StartDir = ImNormalized(startPin && startPin->m_SnapLinkToDir ? startPin->m_Dir : ImCubicBezierTangent(curve.P0, curve.P1, curve.P2, curve.P3, 0.0f));
+    if (item.m_EndArrowSize > 0.0f)
+        item.m_EndDir   = ImNormalized(endPin && endPin->m_SnapLinkToDir ? -endPin->m_Dir : ImCubicBezierTangent(curve.P0, curve.P1, curve.P2, curve.P3, 1.0f));
+
+    m_Items.push_back(item);
+}
+
+void ed::LinkBatcher::Prepare(ImDrawList* drawList, Item& item, float tessellationTolerance)
+{
+    if (item.m_Replay)
+    {
+        item.m_VtxCount = item.m_Cache->GetVertexCount();
+        item.m_IdxCount = item.m_Cache->GetIndexCount();
+        return;
+    }
+
+    const auto& curve = item.m_Curve;
+
+    item.m_PointStart = static_cast<int>(m_Points.size());
+    if (item.m_IsStraight)
+    {
+        // Same as ImDrawList::AddLine()
+        m_Points.push_back(curve.P0 + ImVec2(0.5f, 0.5f));
+        m_Points.push_back(curve.P3 + ImVec2(0.5f, 0.5f));
+    }
+    else
+    {
+        m_Points.push_back(curve.P0);
+        ImCubicBezierTessellate(m_Points, curve, tessellationTolerance);
+    }
+    item.m_PointCount = static_cast<int>(m_Points.size()) - item.m_PointStart;
+
+    ImDrawList_GetPolylineSize(drawList, item.m_PointCount, item.m_Thickness, item.m_VtxCount, item.m_IdxCount);
+
+    if (item.m_IsStraight)
+        return;
+
+    int arrowVtxCount = 0, arrowIdxCount = 0;
+    ImDrawList_GetTriangleSize(drawList, arrowVtxCount, arrowIdxCount);
+
+    if (item.m_StartArrowSize > 0.0f)
+    {
+        item.m_VtxCount += arrowVtxCount;
+        item.m_IdxCount += arrowIdxCount;
+    }
+
+    if (item.m_EndArrowSize > 0.0f)
+    {
+        item.m_VtxCount += arrowVtxCount;
+        item.m_IdxCount += arrowIdxCount;
+    }
+}
+
+void ed::LinkBatcher::Emit(ImDrawList* drawList, const Item& item, ImDrawVert* vtx, ImDrawIdx* idx, unsigned int vtxIndex)
+{
+    if (item.m_Replay)
+    {
+        item.m_Cache->Write(vtx, idx, vtxIndex);
+        return;
+    }
+
+    const auto vtxBegin      = vtx;
+    const auto idxBegin      = idx;
+    const auto vtxIndexBegin = vtxIndex;
+
+    if (static_cast<int>(m_Normals.size()) < item.m_PointCount)
+        m_Normals.resize(item.m_PointCount);
+
+    ImDrawList_WritePolyline(drawList, m_Points.data() + item.m_PointStart, item.m_PointCount, item.m_Color, item.m_Thickness, m_Normals.data(),
+        vtx, idx, vtxIndex);
+
+    if (!item.m_IsStraight)
+    {
+        const auto& curve         = item.m_Curve;
+        const auto  halfThickness = item.m_Thickness * 0.5f;
+
+        if (item.m_StartArrowSize > 0.0f)
+        {
+            const auto normal    = ImVec2(-item.m_StartDir.y, item.m_StartDir.x);
+            const auto halfWidth = ImMax(item.m_StartArrowWidth * 0.5f, halfThickness);
+
+            const ImVec2 points[3] =
+            {
+                curve.P0 - normal * halfWidth,
+                curve.P0 + normal * halfWidth,
+                curve.P0 - item.m_StartDir * item.m_StartArrowSize
+            };
+
+            ImDrawList_WriteTriangle(drawList, points, item.m_Color, vtx, idx, vtxIndex);
+        }
+
+        if (item.m_EndArrowSize > 0.0f)
+        {
+            const auto normal    = ImVec2(-item.m_EndDir.y, item.m_EndDir.x);
+            const auto halfWidth = ImMax(item.m_EndArrowWidth * 0.5f, halfThickness);
+
+            const ImVec2 points[3] =
+            {
+                curve.P3 + normal * halfWidth,
+                curve.P3 - normal * halfWidth,
+                curve.P3 + item.m_EndDir * item.m_EndArrowSize
+            };
+
+            ImDrawList_WriteTriangle(drawList, points, item.m_Color, vtx, idx, vtxIndex);
+        }
+    }
+
+    IM_ASSERT(vtx - vtxBegin == item.m_VtxCount && idx - idxBegin == item.m_IdxCount);
+
+    if (item.m_Cache)
+        item.m_Cache->Store(vtxBegin, item.m_VtxCount, idxBegin, item.m_IdxCount, vtxIndexBegin);
+}
+
+void ed::LinkBatcher::Flush(ImDrawList* drawList)
+{
+    if (m_Items.empty())
+        return;
+
+    const auto lastChannel = drawList->_Splitter._Current;
+
+    // Links keep order they were added in within the channel
+    std::stable_sort(m_Items.begin(), m_Items.end(), [](const Item& lhs, const Item& rhs)
+    {
+        return lhs.m_Channel < rhs.m_Channel;
+    });
+
+    for (auto& item : m_Items)
+        Prepare(drawList, item, m_TessellationTolerance);
+
+    // Over budget links are tessellated once more with coarser tolerance. Points
+    // of adaptive subdivision go with fourth root of squared tolerance, so it is
+    // scaled by fourth power of how many times too many points links took over
+    // two each one needs. Such geometry is not cached, link gets full detail
+    // once budget allows it.
+    auto pointCount = static_cast<int>(m_Points.size());
+    if (m_PointBudget > 0 && m_PointCount + pointCount > m_PointBudget)
+    {
+        int minPointCount = 0;
+        for (auto& item : m_Items)
+            minPointCount += item.m_Replay ? 0 : 2;
+
+        const auto extraPointCount  = pointCount - minPointCount;
+        const auto extraPointBudget = m_PointBudget - m_PointCount - minPointCount;
+
+        auto ratio = c_LinkBudgetMaxPointRatio;
+        if (extraPointBudget > 0)
+            ratio = ImMin(static_cast<float>(extraPointCount) / static_cast<float>(extraPointBudget), c_LinkBudgetMaxPointRatio);
+
+        const auto tolerance = m_TessellationTolerance * ratio * ratio * ratio * ratio;
+
+        m_Points.resize(0);
+        for (auto& item : m_Items)
+        {
+            if (item.m_Replay)
+                continue;
+
+            Prepare(drawList, item, tolerance);
+            item.m_Cache = nullptr;
+        }
+
+        pointCount = static_cast<int>(m_Points.size());
+    }
+    m_PointCount += pointCount;
+
+    // With 16-bit indices batch is split into parts addressable from single
+    // vertex offset. Draw list starts new vertex offset when reservation
+    // does not fit in current one.
+    const unsigned int maxVertexIndex = sizeof(ImDrawIdx) == 2 ? 0xFFFFu : 0xFFFFFFFFu;
+
+    const auto itemCount = static_cast<int>(m_Items.size());
+    for (int first = 0; first < itemCount;)
+    {
+        const auto channel = m_Items[first].m_Channel;
+        if (drawList->_Splitter._Current != channel)
+            drawList->ChannelsSetCurrent(channel);
+
+        auto available = maxVertexIndex - drawList->_VtxCurrentIdx;
+        if (available < static_cast<unsigned int>(m_Items[first].m_VtxCount))
+            available = maxVertexIndex;
+
+        int          last     = first;
+        unsigned int vtxCount = 0;
+        int          idxCount = 0;
+        while (last < itemCount && m_Items[last].m_Channel == channel && (last == first || vtxCount + m_Items[last].m_VtxCount <= available))
+        {
+            vtxCount += m_Items[last].m_VtxCount;
+            idxCount += m_Items[last].m_IdxCount;
+            ++last;
+        }
+
+        drawList->PrimReserve(idxCount, static_cast<int>(vtxCount));
+
+        auto vtx      = drawList->_VtxWritePtr;
+        auto idx      = drawList->_IdxWritePtr;
+        auto vtxIndex = drawList->_VtxCurrentIdx;
+        for (int i = first; i < last; ++i)
+        {
+            const auto& item = m_Items[i];
+
+            Emit(drawList, item, vtx, idx, vtxIndex);
+
+            vtx      += item.m_VtxCount;
+            idx      += item.m_IdxCount;
+            vtxIndex += item.m_VtxCount;
+        }
+
+        drawList->_VtxWritePtr   = vtx;
+        drawList->_IdxWritePtr   = idx;
+        drawList->_VtxCurrentIdx = vtxIndex;
+
+        first = last;
+    }
+
+    if (drawList->_Splitter._Current != lastChannel)
+        drawList->ChannelsSetCurrent(lastChannel);
+
+    m_Items.resize(0);
+    m_Points.resize(0);
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Background Grid
+//
+//------------------------------------------------------------------------------
+void ed::BackgroundGrid::Draw(ImDrawList* drawList, const ImRect& viewRect, float viewScale, ImU32 color)
+{
+    Key key;
+    key.ViewRect        = viewRect;
+    key.ViewScale       = viewScale;
+    key.Color           = color;
+    key.FringeScale     = ImFringeScaleRef(drawList);
+    key.DrawListFlags   = drawList->Flags;
+    key.TexUvWhitePixel = drawList->_Data->TexUvWhitePixel;
+    key.TextureId       = drawList->_CmdHeader.TextureId;
+
+    if (m_Cache.IsValid() && m_Key == key)
+    {
+        drawList->PrimReserve(m_Cache.GetIndexCount(), m_Cache.GetVertexCount());
+        m_Cache.Write(drawList->_VtxWritePtr, drawList->_IdxWritePtr, drawList->_VtxCurrentIdx);
+        drawList->_VtxWritePtr   += m_Cache.GetVertexCount();
+        drawList->_IdxWritePtr   += m_Cache.GetIndexCount();
+        drawList->_VtxCurrentIdx += m_Cache.GetVertexCount();
+        return;
+    }
+
+    m_Key = key;
+    m_Cache.Clear();
+
+    if (viewScale <= 0.0f || viewRect.GetWidth() <= 0.0f || viewRect.GetHeight() <= 0.0f)
+        return;
+
+    const auto invScale = 1.0f / viewScale;
+    const auto extent   = ImMax(viewRect.GetWidth(), viewRect.GetHeight());
+
+    // Pick finest level which is neither too dense on screen nor exceeds
+    // line budget. Spacing limit grows with view, so budget holds for
+    // views of any size.
+    const auto minSpacing = ImMax(c_GridMinLineSpacing, extent * viewScale / c_GridMaxLineCount);
+
+    auto spacing = c_GridSpacing;
+    for (int level = 0; level < 32 && (spacing * viewScale < minSpacing || extent / spacing > c_GridMaxLineCount); ++level)
+        spacing *= c_GridLevelFactor;
+
+    // Minor lines fade in from minimal spacing until they are spaced as
+    // far as major lines were when they took over.
+    const auto screenSpacing = spacing * viewScale;
+    const auto minorAlpha    = ImSaturate((screenSpacing - minSpacing) / (minSpacing * (c_GridLevelFactor - 1)));
+    const auto minorColor    = (color & ~IM_COL32_A_MASK)
+        | (static_cast<ImU32>(((color >> IM_COL32_A_SHIFT) & 0xFF) * minorAlpha + 0.5f) << IM_COL32_A_SHIFT);
+    const auto drawMinor     = (minorColor & IM_COL32_A_MASK) != 0;
+
+    const auto thickness = ImMax(1.0f, invScale);
+    const auto halfPixel = 0.5f * invScale;
+
+    const auto firstX = static_cast<int>(ImCeil(viewRect.Min.x / spacing));
+    const auto lastX  = static_cast<int>(ImFloor(viewRect.Max.x / spacing));
+    const auto firstY = static_cast<int>(ImCeil(viewRect.Min.y / spacing));
+    const auto lastY  = static_cast<int>(ImFloor(viewRect.Max.y / spacing));
+
+    auto isMajor = [](int index) { return index % c_GridLevelFactor == 0; };
+
+    int lineCount = 0;
+    for (int x = firstX; x <= lastX; ++x)
+        if (drawMinor || isMajor(x))
+            ++lineCount;
+    for (int y = firstY; y <= lastY; ++y)
+        if (drawMinor || isMajor(y))
+            ++lineCount;
+
+    if (lineCount == 0)
+        return;
+
+    int lineVtxCount = 0, lineIdxCount = 0;
+    ImDrawList_GetPolylineSize(drawList, 2, thickness, lineVtxCount, lineIdxCount);
+
+    const auto vtxCount = lineCount * lineVtxCount;
+    const auto idxCount = lineCount * lineIdxCount;
+
+    drawList->PrimReserve(idxCount, vtxCount);
+
+    auto vtx      = drawList->_VtxWritePtr;
+    auto idx      = drawList->_IdxWritePtr;
+    auto vtxIndex = drawList->_VtxCurrentIdx;
+
+    const auto vtxBegin      = vtx;
+    const auto idxBegin      = idx;
+    const auto vtxIndexBegin = vtxIndex;
+
+    ImVec2 normals[2];
+    for (int x = firstX; x <= lastX; ++x)
+    {
+        if (!drawMinor && !isMajor(x))
+            continue;
+
+        const ImVec2 points[2] =
+        {
+            ImVec2(x * spacing + halfPixel, viewRect.Min.y + halfPixel),
+            ImVec2(x * spacing + halfPixel, viewRect.Max.y + halfPixel)
+        };
+
+        ImDrawList_WritePolyline(drawList, points, 2, isMajor(x) ? color : minorColor, thickness, normals, vtx, idx, vtxIndex);
+    }
+
+    for (int y = firstY; y <= lastY; ++y)
+    {
+        if (!drawMinor && !isMajor(y))
+            continue;
+
+        const ImVec2 points[2] =
+        {
+            ImVec2(viewRect.Min.x + halfPixel, y * spacing + halfPixel),
+            ImVec2(viewRect.Max.x + halfPixel, y * spacing + halfPixel)
+        };
+
+        ImDrawList_WritePolyline(drawList, points, 2, isMajor(y) ? color : minorColor, thickness, normals, vtx, idx, vtxIndex);
+    }
+
+    IM_ASSERT(vtx - vtxBegin == vtxCount && idx - idxBegin == idxCount);
+
+    m_Cache.Store(vtxBegin, vtxCount, idxBegin, idxCount, vtxIndexBegin);
+
+    drawList->_VtxWritePtr   = vtx;
+    drawList->_IdxWritePtr   = idx;
+    drawList->_VtxCurrentIdx = vtxIndex;
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Frame Cache
+//
+//------------------------------------------------------------------------------
+bool ed::FrameCache::Store(ImDrawList* drawList, int firstChannel, int lastChannel, int vtxStart, const Key& key)
+{
+    Clear();
+
+    const auto& splitter = drawList->_Splitter;
+    for (int channelIndex = firstChannel; channelIndex < lastChannel; ++channelIndex)
+    {
+        // Current channel lives in draw list buffers
+        const auto  isCurrent = channelIndex == splitter._Current;
+        const auto& commands  = isCurrent ? drawList->CmdBuffer : splitter._Channels[channelIndex]._CmdBuffer;
+        const auto& indices   = isCurrent ? drawList->IdxBuffer : splitter._Channels[channelIndex]._IdxBuffer;
+
+        for (const auto& command : commands)
+        {
+            if (command.UserCallback != nullptr)
+            {
+                Clear();
+                return false;
+            }
+
+            if (command.ElemCount == 0)
+                continue;
+
+            const auto idxBegin = indices.Data + command.IdxOffset;
+            const auto idxEnd   = idxBegin + command.ElemCount;
+
+            // Vertices are copied for each command, so it can be replayed
+            // under any vertex offset
+            auto minIndex = static_cast<unsigned int>(*idxBegin);
+            auto maxIndex = minIndex;
+            for (auto idx = idxBegin; idx < idxEnd; ++idx)
+            {
+                minIndex = ImMin(minIndex, static_cast<unsigned int>(*idx));
+                maxIndex = ImMax(maxIndex, static_cast<unsigned int>(*idx));
+            }
+
+            const auto vtxBegin = static_cast<int>(command.VtxOffset + minIndex);
+            const auto vtxCount = static_cast<int>(maxIndex - minIndex + 1);
+            if (vtxBegin < vtxStart || vtxBegin + vtxCount > drawList->VtxBuffer.Size)
+            {
+                Clear();
+                return false;
+            }
+
+            Command cached;
+            cached.m_Channel   = channelIndex;
+            cached.m_ClipRect  = command.ClipRect;
+            cached.m_TextureId = command.TextureId;
+            cached.m_VtxStart  = m_Vertices.Size;
+            cached.m_VtxCount  = vtxCount;
+            cached.m_IdxStart  = m_Indices.Size;
+            cached.m_IdxCount  = static_cast<int>(command.ElemCount);
+            m_Commands.push_back(cached);
+
+            m_Vertices.resize(m_Vertices.Size + vtxCount);
+            memcpy(m_Vertices.Data + cached.m_VtxStart, drawList->VtxBuffer.Data + vtxBegin, vtxCount * sizeof(ImDrawVert));
+
+            m_Indices.resize(m_Indices.Size + cached.m_IdxCount);
+            auto idx = m_Indices.Data + cached.m_IdxStart;
+            for (auto source = idxBegin; source < idxEnd; ++source)
+                *idx++ = static_cast<ImDrawIdx>(*source - minIndex);
+        }
+    }
+
+    m_Key     = key;
+    m_IsValid = true;
+
+    return true;
+}
+
+void ed::FrameCache::Replay(ImDrawList* drawList) const
+{
+    IM_ASSERT(m_IsValid);
+
+    const auto  clipRect    = drawList->_CmdHeader.ClipRect;
+    const auto& keyClipRect = m_Key.ClipRect;
+
+    for (const auto& command : m_Commands)
+    {
+        if (drawList->_Splitter._Current != command.m_Channel)
+            drawList->ChannelsSetCurrent(command.m_Channel);
+
+        auto commandClipRect = clipRect;
+        if (command.m_ClipRect.x != keyClipRect.Min.x || command.m_ClipRect.y != keyClipRect.Min.y
+         || command.m_ClipRect.z != keyClipRect.Max.x || command.m_ClipRect.w != keyClipRect.Max.y)
+        {
+            commandClipRect.x = ImMax(command.m_ClipRect.x, clipRect.x);
+            commandClipRect.y = ImMax(command.m_ClipRect.y, clipRect.y);
+            commandClipRect.z = ImMin(command.m_ClipRect.z, clipRect.z);
+            commandClipRect.w = ImMin(command.m_ClipRect.w, clipRect.w);
+            if (commandClipRect.x >= commandClipRect.z || commandClipRect.y >= commandClipRect.w)
+                continue;
+        }
+
+        drawList->PushClipRect(ImVec2(commandClipRect.x, commandClipRect.y), ImVec2(commandClipRect.z, commandClipRect.w));
+        drawList->PushTextureID(command.m_TextureId);
+
+        drawList->PrimReserve(command.m_IdxCount, command.m_VtxCount);
+
+        const auto base = drawList->_VtxCurrentIdx;
+
+        memcpy(drawList->_VtxWritePtr, m_Vertices.Data + command.m_VtxStart, command.m_VtxCount * sizeof(ImDrawVert));
+        drawList->_VtxWritePtr   += command.m_VtxCount;
+        drawList->_VtxCurrentIdx += command.m_VtxCount;
+
+        auto idx = drawList->_IdxWritePtr;
+        for (int i = 0; i < command.m_IdxCount; ++i)
+            idx[i] = static_cast<ImDrawIdx>(m_Indices[command.m_IdxStart + i] + base);
+        drawList->_IdxWritePtr += command.m_IdxCount;
+
+        drawList->PopTextureID();
+        drawList->PopClipRect();
+    }
+}
+
+void ed::FrameCache::Clear()
+{
+    m_Vertices.resize(0);
+    m_Indices.resize(0);
+    m_Commands.resize(0);
+    m_IsValid = false;
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Node Layer Sorter
+//
+//------------------------------------------------------------------------------
+void ed::NodeLayerSorter::Begin(int channel)
+{
+    m_Channel = channel;
+    m_Segments.resize(0);
+}
+
+void ed::NodeLayerSorter::SetCurrent(ImDrawList* drawList, Node* node, int layer)
+{
+    IM_ASSERT(node != nullptr && layer >= 0 && layer < 32);
+
+    drawList->ChannelsSetCurrent(m_Channel);
+
+    const auto idxStart = drawList->IdxBuffer.Size;
+
+    if (!m_Segments.empty())
+    {
+        auto& lastSegment = m_Segments.back();
+        if (lastSegment.m_Node == node && lastSegment.m_Layer == layer)
+            return;
+
+        // Nothing was drawn since last change, reuse segment
+        if (lastSegment.m_IdxStart == idxStart)
+        {
+            lastSegment.m_Node  = node;
+            lastSegment.m_Layer = layer;
+            return;
+        }
+    }
+
+    m_Segments.push_back({ node, layer, idxStart, 0, 0 });
+}
+
+void ed::NodeLayerSorter::End(ImDrawList* drawList, int groupChannel, int groupCount, unsigned int layerMask)
+{
+    auto& splitter = drawList->_Splitter;
+    IM_ASSERT(splitter._Current != m_Channel && splitter._Current != groupChannel);
+
+    if (m_Segments.empty())
+        return;
+
+    auto& source       = splitter._Channels[m_Channel];
+    auto& groups       = splitter._Channels[groupChannel];
+    auto  segmentCount = static_cast<int>(m_Segments.size());
+
+    // Cut draw commands at segment boundaries. Segments are in drawing order, so
+    // single pass over commands is enough.
+    m_Pieces.resize(0);
+
+    int segmentIndex = 0;
+    m_Segments[0].m_PieceStart = 0;
+
+    auto enterSegmentAt = [this, &segmentIndex, segmentCount](int idx)
+    {
+        while (segmentIndex + 1 < segmentCount && m_Segments[segmentIndex + 1].m_IdxStart <= idx)
+        {
+            m_Segments[segmentIndex].m_PieceEnd = static_cast<int>(m_Pieces.size());
+            ++segmentIndex;
+            m_Segments[segmentIndex].m_PieceStart = static_cast<int>(m_Pieces.size());
+        }
+    };
+
+    for (int i = 0; i < source._CmdBuffer.Size; ++i)
+    {
+        const auto& command = source._CmdBuffer[i];
+
+        auto idx    = static_cast<int>(command.IdxOffset);
+        auto idxEnd = idx + static_cast<int>(command.ElemCount);
+
+        if (idx == idxEnd)
+        {
+            if (command.UserCallback)
+            {
+                enterSegmentAt(idx);
+                m_Pieces.push_back({ i, idx, 0 });
+            }
+            continue;
+        }
+
+        while (idx < idxEnd)
+        {
+            enterSegmentAt(idx);
+
+            auto pieceEnd = idxEnd;
+            if (segmentIndex + 1 < segmentCount)
+                pieceEnd = ImMin(pieceEnd, m_Segments[segmentIndex + 1].m_IdxStart);
+
+            m_Pieces.push_back({ i, idx, pieceEnd - idx });
+            idx = pieceEnd;
+        }
+    }
+
+    m_Segments[segmentIndex].m_PieceEnd = static_cast<int>(m_Pieces.size());
+    for (++segmentIndex; segmentIndex < segmentCount; ++segmentIndex)
+    {
+        m_Segments[segmentIndex].m_PieceStart = static_cast<int>(m_Pieces.size());
+        m_Segments[segmentIndex].m_PieceEnd   = static_cast<int>(m_Pieces.size());
+    }
+
+    // Order segments by node and layer, keep drawing order within same layer
+    m_Order.resize(segmentCount);
+    for (int i = 0; i < segmentCount; ++i)
+        m_Order[i] = i;
+
+    std::stable_sort(m_Order.begin(), m_Order.end(), [this](int lhs, int rhs)
+    {
+        const auto& lhsSegment = m_Segments[lhs];
+        const auto& rhsSegment = m_Segments[rhs];
+        if (lhsSegment.m_Node->m_Order != rhsSegment.m_Node->m_Order)
+            return lhsSegment.m_Node->m_Order < rhsSegment.m_Node->m_Order;
+        return lhsSegment.m_Layer < rhsSegment.m_Layer;
+    });
+
+    groups._CmdBuffer.resize(0);
+    groups._IdxBuffer.resize(0);
+    m_Sorted._CmdBuffer.resize(0);
+    m_Sorted._IdxBuffer.resize(0);
+
+    for (auto index : m_Order)
+    {
+        const auto& segment = m_Segments[index];
+        if ((layerMask & (1u << segment.m_Layer)) == 0)
+            continue;
+
+        auto& target = segment.m_Node->m_Order < groupCount ? groups : m_Sorted;
+
+        for (int i = segment.m_PieceStart; i < segment.m_PieceEnd; ++i)
+        {
+            const auto& piece = m_Pieces[i];
+            ImDrawChannel_AddCommand(target, source._CmdBuffer[piece.m_CommandIndex], source._IdxBuffer.Data + piece.m_IdxStart, piece.m_IdxCount);
+        }
+    }
+
+    source._CmdBuffer.swap(m_Sorted._CmdBuffer);
+    source._IdxBuffer.swap(m_Sorted._IdxBuffer);
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Visibility Culler
+//
+//------------------------------------------------------------------------------
+void ed::VisibilityCuller::Clear()
+{
+    m_MinX.resize(0);
+    m_MinY.resize(0);
+    m_MaxX.resize(0);
+    m_MaxY.resize(0);
+    m_Visible.resize(0);
+}
+
+void ed::VisibilityCuller::Reserve(int count)
+{
+    m_MinX.reserve(count);
+    m_MinY.reserve(count);
+    m_MaxX.reserve(count);
+    m_MaxY.reserve(count);
+    m_Visible.reserve(count);
+}
+
+void ed::VisibilityCuller::Add(const ImRect& bounds)
+{
+    m_MinX.push_back(bounds.Min.x);
+    m_MinY.push_back(bounds.Min.y);
+    m_MaxX.push_back(bounds.Max.x);
+    m_MaxY.push_back(bounds.Max.y);
+}
+
+void ed::VisibilityCuller::CullBounds(const ImRect& clipRect)
+{
+    // Same test as ImGui::IsRectVisible(), which is ImRect::Overlaps()
+    const auto count = static_cast<int>(m_MinX.size());
+    const auto minX  = m_MinX.data();
+    const auto minY  = m_MinY.data();
+    const auto maxX  = m_MaxX.data();
+    const auto maxY  = m_MaxY.data();
+
+    int i = 0;
+
+# if defined(IMGUI_ENABLE_SSE)
+    const auto clipMinX = _mm_set1_ps(clipRect.Min.x);
+    const auto clipMinY = _mm_set1_ps(clipRect.Min.y);
+    const auto clipMaxX = _mm_set1_ps(clipRect.Max.x);
+    const auto clipMaxY = _mm_set1_ps(clipRect.Max.y);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const auto overlapX = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(minX + i), clipMaxX), _mm_cmpgt_ps(_mm_loadu_ps(maxX + i), clipMinX));
+        const auto overlapY = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(minY + i), clipMaxY), _mm_cmpgt_ps(_mm_loadu_ps(maxY + i), clipMinY));
+        const auto mask     = _mm_movemask_ps(_mm_and_ps(overlapX, overlapY));
+        if (mask == 0)
+            continue;
+
+        for (int j = 0; j < 4; ++j)
+            if (mask & (1 << j))
+                m_Visible.push_back(i + j);
+    }
+# elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const auto clipMinX = vdupq_n_f32(clipRect.Min.x);
+    const auto clipMinY = vdupq_n_f32(clipRect.Min.y);
+    const auto clipMaxX = vdupq_n_f32(clipRect.Max.x);
+    const auto clipMaxY = vdupq_n_f32(clipRect.Max.y);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const auto overlapX = vandq_u32(vcltq_f32(vld1q_f32(minX + i), clipMaxX), vcgtq_f32(vld1q_f32(maxX + i), clipMinX));
+        const auto overlapY = vandq_u32(vcltq_f32(vld1q_f32(minY + i), clipMaxY), vcgtq_f32(vld1q_f32(maxY + i), clipMinY));
+        const auto overlap  = vandq_u32(overlapX, overlapY);
+
+        uint32_t mask[4];
+        vst1q_u32(mask, overlap);
+        for (int j = 0; j < 4; ++j)
+            if (mask[j])
+                m_Visible.push_back(i + j);
+    }
+# endif
+
+    for (; i < count; ++i)
+    {
+        if (minX[i] < clipRect.Max.x && maxX[i] > clipRect.Min.x &&
+            minY[i] < clipRect.Max.y && maxY[i] > clipRect.Min.y)
+            m_Visible.push_back(i);
+    }
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Editor Context
+//
+//------------------------------------------------------------------------------
+ed::EditorContext::EditorContext(const ax::NodeEditor::Config* config)
+    : m_Config(config)
+    , m_EditorActiveId(0)
+    , m_LastEditorActiveId(0)
+    , m_ActiveAreaObject()
+    , m_ActiveAreaRegion(NodeRegion::None)
+    , m_IsFirstFrame(true)
+    , m_IsFocused(false)
+    , m_IsHovered(false)
+    , m_IsHoveredWithoutOverlapp(false)
+    , m_ShortcutsEnabled(true)
+    , m_Style()
+    , m_Nodes()
+    , m_Pins()
+    , m_Links()
+    , m_NextLinkOrder(0)
+    , m_SelectionId(1)
+    , m_LastActiveLink(nullptr)
+    , m_Canvas()
+    , m_IsCanvasVisible(false)
+    , m_IsFrameReused(false)
+    , m_IsFrameCacheStale(false)
+    , m_HasFrameMargin(false)
+    , m_IsMarginCaptureFailed(false)
+    , m_IsFrameReplayed(false)
+    , m_FrameCount(0)
+    , m_ReusedFrameCount(0)
+    , m_MarginFrameCount(0)
+    , m_FrameVtxStart(0)
+    , m_FrameExternalIdxCount(0)
+    , m_LevelOfDetail(LevelOfDetail::Full)
+    , m_NodeBuilder(this)
+    , m_HintBuilder(this)
+    , m_CurrentAction(nullptr)
+    , m_NavigateAction(this, m_Canvas)
+    , m_SizeAction(this)
+    , m_DragAction(this)
+    , m_SelectAction(this)
+    , m_ContextMenuAction(this)
+    , m_ShortcutAction(this)
+    , m_CreateItemAction(this)
+    , m_DeleteItemsAction(this)
+    , m_AnimationControllers{ &m_FlowAnimationController }
+    , m_FlowAnimationController(this)
+    , m_HoveredNode(0)
+    , m_HoveredPin(0)
+    , m_HoveredLink(0)
+    , m_DoubleClickedNode(0)
+    , m_DoubleClickedPin(0)
+    , m_DoubleClickedLink(0)
+    , m_BackgroundClickButtonIndex(-1)
+    , m_BackgroundDoubleClickButtonIndex(-1)
+    , m_IsInitialized(false)
+    , m_Settings()
+    , m_DrawList(nullptr)
+    , m_ExternalChannel(0)
+{
+}
+
+ed::EditorContext::~EditorContext()
+{
+    if (m_IsInitialized)
+        SaveSettings();
+
+    for (auto link  : m_Links)  m_LinkPool.Destroy(link.m_Object);
+    for (auto pin   : m_Pins)   m_PinPool.Destroy(pin.m_Object);
+    for (auto node  : m_Nodes)  m_NodePool.Destroy(node.m_Object);
+
+    m_Splitter.ClearFreeMemory();
+}
+
+void ed::EditorContext::Begin(const char* id, const ImVec2& size)
+{
+    // Widget which was active in editor last frame, it may be still active while panning
+    m_LastEditorActiveId = m_EditorActiveId;
+    m_EditorActiveId = ImGui::GetID(id);
+    ImGui::PushID(id);
+
+    auto availableContentSize = ImGui::GetContentRegionAvail();
+    ImVec2 canvasSize = ImFloor(size);
+    if (canvasSize.x <= 0.0f)
+        canvasSize.x = ImMax(4.0f, availableContentSize.x);
+    if (canvasSize.y <= 0.0f)
+        canvasSize.y = ImMax(4.0f, availableContentSize.y);
+
+    if (!m_IsInitialized)
+    {
+        // Cycle canvas, so it has a chance to initialize its size before settings are loaded
+        if (m_Canvas.Begin(id, canvasSize))
+            m_Canvas.End();
+
+        LoadSettings();
+        m_IsInitialized = true;
+    }
+
+    //ImGui::LogToClipboard();
+    //Log("---- begin ----");
+
+    m_DrawList = ImGui::GetWindowDrawList();
+
+    ImDrawList_SwapSplitter(m_DrawList, m_Splitter);
+    m_ExternalChannel = m_DrawList->_Splitter._Current;
+
+    if (m_CurrentAction && m_CurrentAction->IsDragging() && m_NavigateAction.MoveOverEdge(canvasSize))
+    {
+        auto& io = ImGui::GetIO();
+        auto offset = m_NavigateAction.GetMoveScreenOffset();
         for (int i = 0; i < 5; ++i)
             io.MouseClickedPos[i] = io.MouseClickedPos[i] - offset;
     }
@@ -1237,17 +2860,59 @@ void ed::EditorContext::Begin(const char* id, const ImVec2& size)
 
     m_Canvas.SetView(m_NavigateAction.GetView());
 
+    m_LevelOfDetail = CalculateLevelOfDetail(m_Canvas.ViewScale());
+
+    // Objects changed since last frame was captured
+    if (m_IsFrameCacheStale)
+    {
+        m_FrameCache.Clear();
+        m_IsFrameCacheStale = false;
+    }
+
+    // Objects keep state of previous frame while it is replayed
+    m_IsFrameReused = m_IsCanvasVisible && IsFrameReusable();
+
+    // Frame which is likely to be captured is drawn with margin around the view,
+    // following frames replay it for as long as view is panned within it. Frame
+    // captured without margin is drawn again once input settles.
+    m_HasFrameMargin = m_IsCanvasVisible
+        && (!m_IsFrameReused || !m_FrameCache.GetKey().HasMargin)
+        && IsFrameCaptureLikely();
+    if (m_HasFrameMargin)
+        m_IsFrameReused = false;
+
+    if (!m_IsFrameReused)
+        ResetObjects();
+
+    if (m_HasFrameMargin)
+    {
+        const auto margin = m_Canvas.ViewRect().GetSize() * c_FrameCacheMargin;
+        m_Canvas.SetClipMargin(ImFloor(margin));
+        ++m_MarginFrameCount;
+    }
+
+    if (m_IsFrameReused)
+        ++m_ReusedFrameCount;
+    ++m_FrameCount;
+
+    // Tessellation tolerance is squared distance, keep it constant on screen
+    m_LinkBatcher.Begin(m_DrawList->_Data->CurveTessellationTol * m_Canvas.View().InvScale * m_Canvas.View().InvScale, m_Config.LinkTessellationBudget);
+
     // #debug #clip
     //ImGui::Text("CLIP = { x=%g y=%g w=%g h=%g r=%g b=%g }",
     //    clipMin.x, clipMin.y, clipMax.x - clipMin.x, clipMax.y - clipMin.y, clipMax.x, clipMax.y);
 
-    // Reserve channels for background and links
-    ImDrawList_ChannelsGrow(m_DrawList, c_NodeStartChannel);
+    // Reserve channels for background, links and nodes
+    ImDrawList_ChannelsGrow(m_DrawList, c_ChannelCount);
+    m_NodeLayers.Begin(c_NodeChannel);
 
     if (HasSelectionChanged())
         ++m_SelectionId;
 
     m_LastSelectedObjects = m_SelectedObjects;
+
+    m_FrameVtxStart         = m_DrawList->VtxBuffer.Size;
+    m_FrameExternalIdxCount = m_DrawList->IdxBuffer.Size;
 }
 
 void ed::EditorContext::End()
@@ -1261,73 +2926,26 @@ void ed::EditorContext::End()
     m_HoveredLink             = control.HotLink && m_CurrentAction == nullptr ? control.HotLink->m_ID : 0;
     m_DoubleClickedNode       = control.DoubleClickedNode ? control.DoubleClickedNode->m_ID : 0;
     m_DoubleClickedPin        = control.DoubleClickedPin  ? control.DoubleClickedPin->m_ID  : 0;
-    m_DoubleClickedLink       = control.DoubleClickedLink ? control.DoubleClickedLink->m_ID : 0;
-    m_BackgroundClickButtonIndex       = control.BackgroundClickButtonIndex;
-    m_BackgroundDoubleClickButtonIndex = control.BackgroundDoubleClickButtonIndex;
-
-    //if (DoubleClickedNode) LOG_TRACE(0, "DOUBLE CLICK NODE: %d", DoubleClickedNode);
-    //if (DoubleClickedPin)  LOG_TRACE(0, "DOUBLE CLICK PIN:  %d", DoubleClickedPin);
-    //if (DoubleClickedLink) LOG_TRACE(0, "DOUBLE CLICK LINK: %d", DoubleClickedLink);
-    //if (BackgroundDoubleClicked) LOG_TRACE(0, "DOUBLE CLICK BACKGROUND", DoubleClickedLink);
-
-    const bool isSelecting = m_CurrentAction && m_CurrentAction->AsSelect() != nullptr;
-    const bool isDragging  = m_CurrentAction && m_CurrentAction->AsDrag()   != nullptr;
-    //const bool isSizing    = CurrentAction && CurrentAction->AsSize()   != nullptr;
-
-    // Draw nodes
-    for (auto node : m_Nodes)
-        if (node->m_IsLive && node->IsVisible())
-            node->Draw(m_DrawList);
-
-    // Draw links
-    for (auto link : m_Links)
-        if (link->m_IsLive && link->IsVisible())
-            link->Draw(m_DrawList);
-
-    // Highlight selected objects
-    {
-        auto selectedObjects = &m_SelectedObjects;
-        if (auto selectAction = m_CurrentAction ? m_CurrentAction->AsSelect() : nullptr)
-            selectedObjects = &selectAction->m_CandidateObjects;
-
-        for (auto selectedObject : *selectedObjects)
-        {
-            if (selectedObject->IsVisible())
-                selectedObject->Draw(m_DrawList, Object::Selected);
-        }
-
-        // Highlight adjacent links
-        static auto isLinkHighlightedForPin = [](const Pin& pin)
-        {
-            return pin.m_Node->m_HighlightConnectedLinks && pin.m_Node->m_IsSelected;
-        };
-
-        for (auto& link : m_Links)
-        {
-            if (!link->m_IsLive || !link->IsVisible())
-                continue;
+    m_DoubleClickedLink       = control.DoubleClickedLink ? control.DoubleClickedLink->m_ID : 0;
+    m_BackgroundClickButtonIndex       = control.BackgroundClickButtonIndex;
+    m_BackgroundDoubleClickButtonIndex = control.BackgroundDoubleClickButtonIndex;
 
-            auto isLinkHighlighted = isLinkHighlightedForPin(*link->m_StartPin) || isLinkHighlightedForPin(*link->m_EndPin);
-            if (!isLinkHighlighted)
-                continue;
+    //if (DoubleClickedNode) LOG_TRACE(0, "DOUBLE CLICK NODE: %d", DoubleClickedNode);
+    //if (DoubleClickedPin)  LOG_TRACE(0, "DOUBLE CLICK PIN:  %d", DoubleClickedPin);
+    //if (DoubleClickedLink) LOG_TRACE(0, "DOUBLE CLICK LINK: %d", DoubleClickedLink);
+    //if (BackgroundDoubleClicked) LOG_TRACE(0, "DOUBLE CLICK BACKGROUND", DoubleClickedLink);
 
-            link->Draw(m_DrawList, Object::Highlighted);
-        }
-    }
+    const bool isDragging  = m_CurrentAction && m_CurrentAction->AsDrag()   != nullptr;
+    //const bool isSizing    = CurrentAction && CurrentAction->AsSize()   != nullptr;
 
-    if (!isSelecting)
-    {
-        auto hoveredObject = control.HotObject;
-        if (auto dragAction = m_CurrentAction ? m_CurrentAction->AsDrag() : nullptr)
-            hoveredObject = dragAction->m_DraggedObject;
-        if (auto sizeAction = m_CurrentAction ? m_CurrentAction->AsSize() : nullptr)
-            hoveredObject = sizeAction->m_SizedNode;
+    // Only frames without any interaction going on are worth replaying
+    bool isFrameCapturable = !m_IsFrameReused && !m_CurrentAction
+        && static_cast<int>(m_LiveAnimations.size()) == (m_NavigateAction.IsAnimating() ? 1 : 0);
 
-        if (hoveredObject && !IsSelected(hoveredObject) && hoveredObject->IsVisible())
-            hoveredObject->Draw(m_DrawList, Object::Hovered);
-    }
+    if (!m_IsFrameReused)
+        DrawObjects(control);
 
-    // Draw animations
+    // Draw animations, links they follow are still there in replayed frame
     for (auto controller : m_AnimationControllers)
         controller->Draw(m_DrawList);
 
@@ -1434,70 +3052,44 @@ void ed::EditorContext::End()
         return lhs->m_ZPosition < rhs->m_ZPosition;
     });
 
-# if 1
-    // Every node has few channels assigned. Grow channel list
-    // to hold twice as much of channels and place them in
-    // node drawing order.
-    {
-        // Copy group nodes
-        auto liveNodeCount = static_cast<int>(std::count_if(m_Nodes.begin(), m_Nodes.end(), [](Node* node) { return node->m_IsLive; }));
-
-        // Reserve two additional channels for sorted list of channels
-        auto nodeChannelCount = m_DrawList->_Splitter._Count;
-        ImDrawList_ChannelsGrow(m_DrawList, m_DrawList->_Splitter._Count + c_ChannelsPerNode * liveNodeCount + c_LinkChannelCount);
-
-        int targetChannel = nodeChannelCount;
-
-        auto copyNode = [this, &targetChannel](Node* node)
-        {
-            if (!node->m_IsLive)
-                return;
-
-            for (int i = 0; i < c_ChannelsPerNode; ++i)
-                ImDrawList_SwapChannels(m_DrawList, node->m_Channel + i, targetChannel + i);
-
-            node->m_Channel = targetChannel;
-            targetChannel += c_ChannelsPerNode;
-        };
+    UpdateNodeOrder();
 
+    // Put node drawing in order. Groups are drawn below links, other nodes above them.
+    if (!m_IsFrameReused)
+    {
         auto groupsItEnd = std::find_if(m_Nodes.begin(), m_Nodes.end(), [](Node* node) { return !IsGroup(node); });
+        auto groupCount  = static_cast<int>(groupsItEnd - m_Nodes.begin());
 
-        // Copy group nodes
-        std::for_each(m_Nodes.begin(), groupsItEnd, copyNode);
+        auto layerMask = ~0u;
 
-        // Copy links
-        for (int i = 0; i < c_LinkChannelCount; ++i, ++targetChannel)
-            ImDrawList_SwapChannels(m_DrawList, c_LinkStartChannel + i, targetChannel);
+        // Node content is too small to be read, drop what user submitted
+        if (m_LevelOfDetail == LevelOfDetail::Minimal)
+            layerMask &= ~((1u << c_NodeLayer_UserBackground) | (1u << c_NodeLayer_Pin) | (1u << c_NodeLayer_Content));
 
-        // Copy normal nodes
-        std::for_each(groupsItEnd, m_Nodes.end(), copyNode);
+        m_DrawList->ChannelsSetCurrent(c_UserChannel_Grid);
+        m_NodeLayers.End(m_DrawList, c_GroupChannel, groupCount, layerMask);
     }
-# endif
 
     // ImGui::PopClipRect();
 
     // Draw grid
-# if 1 // #FIXME
     {
-        //auto& style = ImGui::GetStyle();
-
         m_DrawList->ChannelsSetCurrent(c_UserChannel_Grid);
 
-        ImVec2 offset    = m_Canvas.ViewOrigin() * (1.0f / m_Canvas.ViewScale());
-        ImU32 GRID_COLOR = GetColor(StyleColor_Grid, ImClamp(m_Canvas.ViewScale() * m_Canvas.ViewScale(), 0.0f, 1.0f));
-        float GRID_SX    = 32.0f;// * m_Canvas.ViewScale();
-        float GRID_SY    = 32.0f;// * m_Canvas.ViewScale();
-        ImVec2 VIEW_POS  = m_Canvas.ViewRect().Min;
-        ImVec2 VIEW_SIZE = m_Canvas.ViewRect().GetSize();
+        m_DrawList->AddRectFilled(m_Canvas.ViewRect().Min, m_Canvas.ViewRect().Max, GetColor(StyleColor_Bg));
 
-        m_DrawList->AddRectFilled(VIEW_POS, VIEW_POS + VIEW_SIZE, GetColor(StyleColor_Bg));
+        // Whole grid fades out while zooming out, on top of fading between levels
+        const auto gridAlpha = ImClamp(m_Canvas.ViewScale() * m_Canvas.ViewScale(), 0.0f, 1.0f);
 
-        for (float x = fmodf(offset.x, GRID_SX); x < VIEW_SIZE.x; x += GRID_SX)
-            m_DrawList->AddLine(ImVec2(x, 0.0f) + VIEW_POS, ImVec2(x, VIEW_SIZE.y) + VIEW_POS, GRID_COLOR);
-        for (float y = fmodf(offset.y, GRID_SY); y < VIEW_SIZE.y; y += GRID_SY)
-            m_DrawList->AddLine(ImVec2(0.0f, y) + VIEW_POS, ImVec2(VIEW_SIZE.x, y) + VIEW_POS, GRID_COLOR);
+        m_BackgroundGrid.Draw(m_DrawList, m_Canvas.ViewRect(), m_Canvas.ViewScale(), GetColor(StyleColor_Grid, gridAlpha));
+    }
+
+    // Draw previous frame
+    if (m_IsFrameReused)
+    {
+        m_FrameCache.Replay(m_DrawList);
+        m_IsFrameReplayed = true;
     }
-# endif
 
 # if 0
     {
@@ -1539,15 +3131,11 @@ void ed::EditorContext::End()
         // These channels already have clip planes in global space, so
         // we move them to clip plane. Batch transformation in canvas
         // will bring them back to global space.
-        auto preTransformClipRect = [this](int channelIndex)
+        const auto origin = ToScreen(ImVec2(0.0f, 0.0f));
+        auto preTransformClipRect = [this, origin](int channelIndex)
         {
             ImDrawChannel& channel = m_DrawList->_Splitter._Channels[channelIndex];
-            for (ImDrawCmd& cmd : channel._CmdBuffer)
-            {
-                auto a = ToCanvas(ImVec2(cmd.ClipRect.x, cmd.ClipRect.y));
-                auto b = ToCanvas(ImVec2(cmd.ClipRect.z, cmd.ClipRect.w));
-                cmd.ClipRect = ImVec4(a.x, a.y, b.x, b.y);
-            }
+            ImGuiEx::TransformClipRects(channel._CmdBuffer.begin(), channel._CmdBuffer.end(), ImVec2(-origin.x, -origin.y), GetView().InvScale, ImVec2(0.0f, 0.0f));
         };
 
         m_DrawList->ChannelsSetCurrent(0);
@@ -1566,6 +3154,54 @@ void ed::EditorContext::End()
 
     UpdateAnimations();
 
+    // Capture geometry of objects, next frame may only replay it. User and hint
+    // channels are not captured, so they must be empty. Same goes for anything
+    // drawn in screen space or outside editor channels.
+    if (m_IsFrameReused)
+    {
+        // Hovered object is highlighted, replay cannot show it changed
+        if (control.HotObject != m_FrameCache.GetKey().HotObject)
+            m_FrameCache.Clear();
+    }
+    else
+    {
+        const auto channelCount = m_DrawList->_Splitter._Count;
+        for (int i = channelCount - 3; i < channelCount; ++i)
+            isFrameCapturable = isFrameCapturable && m_DrawList->_Splitter._Channels[i]._IdxBuffer.empty();
+
+        // Objects changed while frame was drawn, geometry may not match their state
+        isFrameCapturable = isFrameCapturable
+            && !m_IsFrameCacheStale
+            && m_IsCanvasVisible
+            && !m_CurrentAction
+            && m_DrawList->IdxBuffer.Size == m_FrameExternalIdxCount
+            && m_Canvas.IsLocalSpace(m_FrameVtxStart);
+
+        if (isFrameCapturable)
+        {
+            FrameCache::Key key;
+            key.ClipRect        = ImGui::GetCurrentWindow()->ClipRect;
+            key.ViewScale       = m_Canvas.ViewScale();
+            key.Detail          = m_LevelOfDetail;
+            key.HotObject       = control.HotObject;
+            key.Font            = m_DrawList->_Data->Font;
+            key.FontSize        = m_DrawList->_Data->FontSize;
+            key.DrawListFlags   = m_DrawList->Flags;
+            key.TexUvWhitePixel = m_DrawList->_Data->TexUvWhitePixel;
+            key.EditorStyle     = m_Style;
+            key.HasMargin       = m_HasFrameMargin;
+
+            isFrameCapturable = m_FrameCache.Store(m_DrawList, c_BackgroundChannelStart, c_ChannelCount, m_FrameVtxStart, key);
+        }
+        else
+            m_FrameCache.Clear();
+
+        if (isFrameCapturable)
+            m_IsMarginCaptureFailed = false;
+        else if (m_HasFrameMargin)
+            m_IsMarginCaptureFailed = true;
+    }
+
     m_DrawList->ChannelsMerge();
 
     // #debug
@@ -1610,10 +3246,208 @@ void ed::EditorContext::End()
     m_IsFirstFrame = false;
 }
 
+void ed::EditorContext::CancelFrameReuse()
+{
+    if (!m_IsFrameReused)
+        return;
+
+    m_IsFrameReused   = false;
+    m_IsFrameReplayed = false;
+    ResetObjects();
+}
+
+void ed::EditorContext::ResetObjects()
+{
+    static auto resetAndCollect = [](auto& objects, auto& index, auto& pool)
+    {
+        objects.erase(std::remove_if(objects.begin(), objects.end(), [&index, &pool](auto objectWrapper)
+        {
+            if (objectWrapper->m_DeleteOnNewFrame)
+            {
+                index.Remove(objectWrapper.m_ID);
+                pool.Destroy(objectWrapper.m_Object);
+                return true;
+            }
+            else
+            {
+                objectWrapper->Reset();
+                return false;
+            }
+        }), objects.end());
+    };
+
+    resetAndCollect(m_Nodes, m_NodeIndex, m_NodePool);
+    resetAndCollect(m_Pins,  m_PinIndex,  m_PinPool);
+    resetAndCollect(m_Links, m_LinkIndex, m_LinkPool);
+
+    UpdateNodeOrder();
+
+    m_NodeBuilder.m_MaxGroupBorderWidth = 0.0f;
+}
+
+void ed::EditorContext::DrawObjects(const Control& control)
+{
+    const bool isSelecting = m_CurrentAction && m_CurrentAction->AsSelect() != nullptr;
+
+    // Resolve visibility of all nodes and links at once
+    const auto clipRect = ImGui::GetCurrentWindow()->ClipRect;
+    m_NodeCuller.Cull(m_Nodes, clipRect);
+    m_LinkCuller.Cull(m_Links, clipRect);
+
+    // Draw nodes
+    for (auto index : m_NodeCuller.GetVisible())
+        m_Nodes[index]->Draw(m_DrawList);
+
+    // Draw links
+    for (auto index : m_LinkCuller.GetVisible())
+        m_Links[index]->Draw(m_DrawList);
+
+    // Highlight selected objects
+    {
+        auto selectedObjects = &m_SelectedObjects;
+        if (auto selectAction = m_CurrentAction ? m_CurrentAction->AsSelect() : nullptr)
+            selectedObjects = &selectAction->m_CandidateObjects;
+
+        for (auto selectedObject : *selectedObjects)
+        {
+            if (selectedObject->IsVisible())
+                selectedObject->Draw(m_DrawList, Object::Selected);
+        }
+
+        // Highlight adjacent links
+        static auto isLinkHighlightedForNode = [](const Node& node)
+        {
+            return node.m_HighlightConnectedLinks && node.m_IsSelected;
+        };
+
+        for (auto selectedObject : m_SelectedObjects)
+        {
+            auto node = selectedObject->AsNode();
+            if (!node || !isLinkHighlightedForNode(*node))
+                continue;
+
+            ForEachLink(node, [this, node](Link* link)
+            {
+                // Link between two highlighted nodes is drawn once, from start node
+                auto startNode = link->m_StartPin->m_Node;
+                if (startNode != node && isLinkHighlightedForNode(*startNode))
+                    return true;
+
+                if (link->IsVisible())
+                    link->Draw(m_DrawList, Object::Highlighted);
+
+                return true;
+            });
+        }
+    }
+
+    if (!isSelecting)
+    {
+        auto hoveredObject = control.HotObject;
+        if (auto dragAction = m_CurrentAction ? m_CurrentAction->AsDrag() : nullptr)
+            hoveredObject = dragAction->m_DraggedObject;
+        if (auto sizeAction = m_CurrentAction ? m_CurrentAction->AsSize() : nullptr)
+            hoveredObject = sizeAction->m_SizedNode;
+
+        if (hoveredObject && !IsSelected(hoveredObject) && hoveredObject->IsVisible())
+            hoveredObject->Draw(m_DrawList, Object::Hovered);
+    }
+
+    // Emit all links drawn above
+    m_LinkBatcher.Flush(m_DrawList);
+}
+
+bool ed::EditorContext::IsFrameReusable()
+{
+    if (!m_FrameCache.IsValid() || m_IsFirstFrame || m_CurrentAction)
+        return false;
+
+    if (HasSelectionChanged() || m_DeleteItemsAction.HasManuallyDeletedObjects())
+        return false;
+
+    // Navigation is the only animation which does not draw anything
+    const auto isNavigating = m_NavigateAction.IsAnimating();
+    if (static_cast<int>(m_LiveAnimations.size()) != (isNavigating ? 1 : 0))
+        return false;
+
+    // Objects outside of captured area were culled, view must stay inside of it.
+    // Captured area reaches past the view by margin, see IsFrameCaptureLikely().
+    // Geometry is tessellated for the scale it was captured at, different scale
+    // is fine only for frames in between navigation animation.
+    const auto& key = m_FrameCache.GetKey();
+    const auto  clipRect = ImGui::GetCurrentWindow()->ClipRect;
+    if (!key.ClipRect.Contains(clipRect) || key.Detail != m_LevelOfDetail)
+        return false;
+    if (key.ViewScale != m_Canvas.ViewScale() && !isNavigating)
+        return false;
+
+    if (key.Font != m_DrawList->_Data->Font || key.FontSize != m_DrawList->_Data->FontSize
+     || key.DrawListFlags != m_DrawList->Flags || key.TexUvWhitePixel != m_DrawList->_Data->TexUvWhitePixel)
+        return false;
+
+    if (memcmp(&key.EditorStyle, static_cast<const NodeEditor::Style*>(&m_Style), sizeof(NodeEditor::Style)) != 0)
+        return false;
+
+    return IsInputIdle();
+}
+
+bool ed::EditorContext::IsFrameCaptureLikely() const
+{
+    // Last frame drawn with margin was not captured, do not waste time on another
+    if (m_CurrentAction || m_IsMarginCaptureFailed)
+        return false;
+
+    // Margin only pays off when application skips objects while frame is reused
+    if (!m_IsFrameReplayed)
+        return false;
+
+    const auto isNavigating = m_NavigateAction.IsAnimating();
+    if (static_cast<int>(m_LiveAnimations.size()) != (isNavigating ? 1 : 0))
+        return false;
+
+    // Widgets in margin could be hovered by mouse outside of the view
+    if (ImGui::IsWindowHovered(ImGuiHoveredFlags_AllowWhenBlockedByActiveItem))
+    {
+        const auto& clipRect = ImGui::GetCurrentWindow()->ClipRect;
+        if (!clipRect.Contains(ImGui::GetMousePos()))
+            return false;
+    }
+
+    return IsInputIdle();
+}
+
+bool ed::EditorContext::IsInputIdle() const
+{
+    auto& io = ImGui::GetIO();
+
+    // Mouse may only move the view
+    const auto isPanning = m_NavigateAction.m_IsActive;
+    for (int i = 0; i < IM_ARRAYSIZE(io.MouseDown); ++i)
+    {
+        const auto isHeld = io.MouseDown[i] && !(isPanning && i == m_Config.NavigateButtonIndex);
+        if (isHeld || io.MouseReleased[i])
+            return false;
+    }
+
+    if (!isPanning && (io.MouseDelta.x != 0.0f || io.MouseDelta.y != 0.0f))
+        return false;
+
+    // Widgets inside nodes may be edited
+    if (!io.InputQueueCharacters.empty())
+        return false;
+
+    if (ImGui::IsAnyItemActive() && !(isPanning && ImGui::GetActiveID() == m_LastEditorActiveId))
+        return false;
+
+    return true;
+}
+
 bool ed::EditorContext::DoLink(LinkId id, PinId startPinId, PinId endPinId, ImU32 color, float thickness)
 {
     //auto& editorStyle = GetStyle();
 
+    CancelFrameReuse();
+
     auto startPin = FindPin(startPinId);
     auto endPin   = FindPin(endPinId);
 
@@ -1631,7 +3465,9 @@ bool ed::EditorContext::DoLink(LinkId id, PinId startPinId, PinId endPinId, ImU3
     link->m_Thickness     = thickness;
     link->m_IsLive        = true;
 
+    link->AttachToPins(startPin, endPin);
     link->UpdateEndpoints();
+    UpdateLinkGrid(link);
 
     return true;
 }
@@ -1649,6 +3485,7 @@ void ed::EditorContext::SetNodePosition(NodeId nodeId, const ImVec2& position)
     {
         node->m_Bounds.Translate(position - node->m_Bounds.Min);
         node->m_Bounds.Floor();
+        UpdateNodeGrid(node);
         MakeDirty(NodeEditor::SaveReasonFlags::Position, node);
     }
 }
@@ -1750,6 +3587,7 @@ void ed::EditorContext::UpdateNodeState(Node* node)
     node->m_GroupBounds.Min = settings->m_Location;
     node->m_GroupBounds.Max = node->m_GroupBounds.Min + settings->m_GroupSize;
     node->m_GroupBounds.Floor();
+    UpdateNodeGrid(node);
 }
 
 void ed::EditorContext::RemoveSettings(Object* object)
@@ -1833,13 +3671,25 @@ bool ed::EditorContext::HasSelectionChanged()
     return m_LastSelectedObjects != m_SelectedObjects;
 }
 
-ed::Node* ed::EditorContext::FindNodeAt(const ImVec2& p)
+void ed::EditorContext::UpdateNodeOrder()
 {
+    int order = 0;
     for (auto node : m_Nodes)
-        if (node->TestHit(p))
-            return node;
+        node->m_Order = order++;
+}
 
-    return nullptr;
+ed::Node* ed::EditorContext::FindNodeAt(const ImVec2& p)
+{
+    m_NodeQuery.resize(0);
+    m_NodeGrid.Query(p, m_NodeQuery);
+
+    // Report node which comes first in m_Nodes, like linear search does
+    Node* result = nullptr;
+    for (auto node : m_NodeQuery)
+        if ((!result || node->m_Order < result->m_Order) && node->TestHit(p))
+            result = node;
+
+    return result;
 }
 
 void ed::EditorContext::FindNodesInRect(const ImRect& r, vector<Node*>& result, bool append, bool includeIntersecting)
@@ -1850,9 +3700,22 @@ void ed::EditorContext::FindNodesInRect(const ImRect& r, vector<Node*>& result,
     if (ImRect_IsEmpty(r))
         return;
 
-    for (auto node : m_Nodes)
-        if (node->TestHit(r, includeIntersecting))
-            result.push_back(node);
+    m_NodeQuery.resize(0);
+    m_NodeGrid.Query(r, m_NodeQuery);
+
+    m_NodeQuery.erase(std::remove_if(m_NodeQuery.begin(), m_NodeQuery.end(), [&r, includeIntersecting](Node* node)
+    {
+        return !node->TestHit(r, includeIntersecting);
+    }), m_NodeQuery.end());
+
+    // Node spanning several cells is reported more than once, keep only one in m_Nodes order
+    std::sort(m_NodeQuery.begin(), m_NodeQuery.end(), [](const Node* lhs, const Node* rhs)
+    {
+        return lhs->m_Order < rhs->m_Order;
+    });
+    m_NodeQuery.erase(std::unique(m_NodeQuery.begin(), m_NodeQuery.end()), m_NodeQuery.end());
+
+    result.insert(result.end(), m_NodeQuery.begin(), m_NodeQuery.end());
 }
 
 void ed::EditorContext::FindLinksInRect(const ImRect& r, vector<Link*>& result, bool append)
@@ -1863,69 +3726,66 @@ void ed::EditorContext::FindLinksInRect(const ImRect& r, vector<Link*>& result,
     if (ImRect_IsEmpty(r))
         return;
 
-    for (auto link : m_Links)
-        if (link->TestHit(r))
-            result.push_back(link);
+    m_LinkQuery.resize(0);
+    m_LinkGrid.Query(r, m_LinkQuery);
+
+    m_LinkQuery.erase(std::remove_if(m_LinkQuery.begin(), m_LinkQuery.end(), [&r](Link* link)
+    {
+        return !link->TestHit(r);
+    }), m_LinkQuery.end());
+
+    // Link spanning several cells is reported more than once, keep only one in m_Links order
+    std::sort(m_LinkQuery.begin(), m_LinkQuery.end(), [](const Link* lhs, const Link* rhs)
+    {
+        return lhs->m_Order < rhs->m_Order;
+    });
+    m_LinkQuery.erase(std::unique(m_LinkQuery.begin(), m_LinkQuery.end()), m_LinkQuery.end());
+
+    result.insert(result.end(), m_LinkQuery.begin(), m_LinkQuery.end());
 }
 
 bool ed::EditorContext::HasAnyLinks(NodeId nodeId) const
 {
-    for (auto link : m_Links)
-    {
-        if (!link->m_IsLive)
-            continue;
-
-        if (link->m_StartPin->m_Node->m_ID == nodeId || link->m_EndPin->m_Node->m_ID == nodeId)
-            return true;
-    }
+    auto node = m_NodeIndex.Find(nodeId);
+    if (!node)
+        return false;
 
-    return false;
+    return !ForEachLink(node, [](Link*) { return false; });
 }
 
 bool ed::EditorContext::HasAnyLinks(PinId pinId) const
 {
-    for (auto link : m_Links)
-    {
-        if (!link->m_IsLive)
-            continue;
-
-        if (link->m_StartPin->m_ID == pinId || link->m_EndPin->m_ID == pinId)
-            return true;
-    }
+    auto pin = m_PinIndex.Find(pinId);
+    if (!pin)
+        return false;
 
-    return false;
+    return !ForEachLink(pin, [](Link*) { return false; });
 }
 
 int ed::EditorContext::BreakLinks(NodeId nodeId)
 {
+    vector<Link*> links;
+    FindLinksForNode(nodeId, links);
+
     int result = 0;
-    for (auto link : m_Links)
+    for (auto link : links)
     {
-        if (!link->m_IsLive)
-            continue;
-
-        if (link->m_StartPin->m_Node->m_ID == nodeId || link->m_EndPin->m_Node->m_ID == nodeId)
-        {
-            if (GetItemDeleter().Add(link))
-                ++result;
-        }
+        if (GetItemDeleter().Add(link))
+            ++result;
     }
     return result;
 }
 
 int ed::EditorContext::BreakLinks(PinId pinId)
 {
+    vector<Link*> links;
+    FindLinksForPin(pinId, links);
+
     int result = 0;
-    for (auto link : m_Links)
+    for (auto link : links)
     {
-        if (!link->m_IsLive)
-            continue;
-
-        if (link->m_StartPin->m_ID == pinId || link->m_EndPin->m_ID == pinId)
-        {
-            if (GetItemDeleter().Add(link))
-                ++result;
-        }
+        if (GetItemDeleter().Add(link))
+            ++result;
     }
     return result;
 }
@@ -1935,14 +3795,23 @@ void ed::EditorContext::FindLinksForNode(NodeId nodeId, vector<Link*>& result, b
     if (!add)
         result.clear();
 
-    for (auto link : m_Links)
-    {
-        if (!link->m_IsLive)
-            continue;
+    auto node = FindNode(nodeId);
+    if (!node)
+        return;
 
-        if (link->m_StartPin->m_Node->m_ID == nodeId || link->m_EndPin->m_Node->m_ID == nodeId)
-            result.push_back(link);
-    }
+    ForEachLink(node, [&result](Link* link) { result.push_back(link); return true; });
+}
+
+void ed::EditorContext::FindLinksForPin(PinId pinId, vector<Link*>& result, bool add)
+{
+    if (!add)
+        result.clear();
+
+    auto pin = FindPin(pinId);
+    if (!pin)
+        return;
+
+    ForEachLink(pin, [&result](Link* link) { result.push_back(link); return true; });
 }
 
 bool ed::EditorContext::PinHadAnyLinks(PinId pinId)
@@ -1963,11 +3832,14 @@ void ed::EditorContext::NotifyLinkDeleted(Link* link)
 void ed::EditorContext::Suspend(SuspendFlags flags)
 {
     IM_ASSERT(m_DrawList != nullptr && "Suspend was called outiside of Begin/End.");
+    const auto hasEditorSplitter = m_NodeBuilder.BeginEditorSplitter(m_DrawList);
     auto lastChannel = m_DrawList->_Splitter._Current;
     m_DrawList->ChannelsSetCurrent(m_ExternalChannel);
     if (m_IsCanvasVisible)
         m_Canvas.Suspend();
     m_DrawList->ChannelsSetCurrent(lastChannel);
+    if (hasEditorSplitter)
+        m_NodeBuilder.EndEditorSplitter(m_DrawList);
     if ((flags & SuspendFlags::KeepSplitter) != SuspendFlags::KeepSplitter)
         ImDrawList_SwapSplitter(m_DrawList, m_Splitter);
 }
@@ -1977,11 +3849,14 @@ void ed::EditorContext::Resume(SuspendFlags flags)
     IM_ASSERT(m_DrawList != nullptr && "Reasume was called outiside of Begin/End.");
     if ((flags & SuspendFlags::KeepSplitter) != SuspendFlags::KeepSplitter)
         ImDrawList_SwapSplitter(m_DrawList, m_Splitter);
+    const auto hasEditorSplitter = m_NodeBuilder.BeginEditorSplitter(m_DrawList);
     auto lastChannel = m_DrawList->_Splitter._Current;
     m_DrawList->ChannelsSetCurrent(m_ExternalChannel);
     if (m_IsCanvasVisible)
         m_Canvas.Resume();
     m_DrawList->ChannelsSetCurrent(lastChannel);
+    if (hasEditorSplitter)
+        m_NodeBuilder.EndEditorSplitter(m_DrawList);
 }
 
 bool ed::EditorContext::IsSuspended()
@@ -2027,18 +3902,20 @@ int ed::EditorContext::CountLiveLinks() const
 ed::Pin* ed::EditorContext::CreatePin(PinId id, PinKind kind)
 {
     IM_ASSERT(nullptr == FindObject(id));
-    auto pin = new Pin(this, id, kind);
+    auto pin = m_PinPool.Create(this, id, kind);
     m_Pins.push_back({id, pin});
-    std::sort(m_Pins.begin(), m_Pins.end());
+    m_PinIndex.Insert(id, pin);
     return pin;
 }
 
 ed::Node* ed::EditorContext::CreateNode(NodeId id)
 {
     IM_ASSERT(nullptr == FindObject(id));
-    auto node = new Node(this, id);
+    auto node = m_NodePool.Create(this, id);
+    node->m_Order = static_cast<int>(m_Nodes.size());
     m_Nodes.push_back({id, node});
-    //std::sort(Nodes.begin(), Nodes.end());
+    m_NodeIndex.Insert(id, node);
+    UpdateNodeGrid(node);
 
     auto settings = m_Settings.FindNode(id);
     if (!settings)
@@ -2057,68 +3934,27 @@ ed::Node* ed::EditorContext::CreateNode(NodeId id)
 ed::Link* ed::EditorContext::CreateLink(LinkId id)
 {
     IM_ASSERT(nullptr == FindObject(id));
-    auto link = new Link(this, id);
+    auto link = m_LinkPool.Create(this, id);
+    link->m_Order = m_NextLinkOrder++;
     m_Links.push_back({id, link});
-    std::sort(m_Links.begin(), m_Links.end());
+    m_LinkIndex.Insert(id, link);
 
     return link;
 }
 
-template <typename C, typename Id>
-static inline auto FindItemInLinear(C& container, Id id)
-{
-# if defined(_DEBUG)
-    auto start = container.data();
-    auto end   = container.data() + container.size();
-    for (auto it = start; it < end; ++it)
-        if ((*it).m_ID == id)
-            return it->m_Object;
-# else
-    for (auto item : container)
-        if (item.m_ID == id)
-            return item.m_Object;
-# endif
-
-   return static_cast<decltype(container[0].m_Object)>(nullptr);
-}
-
-template <typename C, typename Id>
-static inline auto FindItemIn(C& container, Id id)
-{
-//# if defined(_DEBUG)
-//    auto start = container.data();
-//    auto end   = container.data() + container.size();
-//    for (auto it = start; it < end; ++it)
-//        if ((*it)->ID == id)
-//            return *it;
-//# else
-//    for (auto item : container)
-//        if (item->ID == id)
-//            return item;
-//# endif
-    auto key = typename C::value_type{ id, nullptr };
-    auto first = container.cbegin();
-    auto last  = container.cend();
-    auto it    = std::lower_bound(first, last, key);
-    if (it != last && (key.m_ID == it->m_ID))
-        return it->m_Object;
-    else
-        return static_cast<decltype(it->m_Object)>(nullptr);
-}
-
 ed::Node* ed::EditorContext::FindNode(NodeId id)
 {
-    return FindItemInLinear(m_Nodes, id);
+    return m_NodeIndex.Find(id);
 }
 
 ed::Pin* ed::EditorContext::FindPin(PinId id)
 {
-    return FindItemIn(m_Pins, id);
+    return m_PinIndex.Find(id);
 }
 
 ed::Link* ed::EditorContext::FindLink(LinkId id)
 {
-    return FindItemIn(m_Links, id);
+    return m_LinkIndex.Find(id);
 }
 
 ed::Object* ed::EditorContext::FindObject(ObjectId id)
@@ -2210,17 +4046,34 @@ void ed::EditorContext::SaveSettings()
 
 void ed::EditorContext::MakeDirty(SaveReasonFlags reason)
 {
+    // Frame cache may be already replaying, drop it in next Begin()
+    if ((reason | SaveReasonFlags::Navigation) != SaveReasonFlags::Navigation)
+        m_IsFrameCacheStale = true;
+
     m_Settings.MakeDirty(reason);
 }
 
 void ed::EditorContext::MakeDirty(SaveReasonFlags reason, Node* node)
 {
+    if ((reason | SaveReasonFlags::Navigation) != SaveReasonFlags::Navigation)
+        m_IsFrameCacheStale = true;
+
     m_Settings.MakeDirty(reason, node);
 }
 
 ed::Link* ed::EditorContext::FindLinkAt(const ImVec2& p)
 {
-    for (auto& link : m_Links)
+    m_LinkQuery.resize(0);
+    m_LinkGrid.Query(ImRect(p - ImVec2(c_LinkSelectThickness, c_LinkSelectThickness), p + ImVec2(c_LinkSelectThickness, c_LinkSelectThickness)), m_LinkQuery);
+
+    // Test candidates in m_Links order, first hit is the same link linear search would find
+    std::sort(m_LinkQuery.begin(), m_LinkQuery.end(), [](const Link* lhs, const Link* rhs)
+    {
+        return lhs->m_Order < rhs->m_Order;
+    });
+    m_LinkQuery.erase(std::unique(m_LinkQuery.begin(), m_LinkQuery.end()), m_LinkQuery.end());
+
+    for (auto link : m_LinkQuery)
         if (link->TestHit(p, c_LinkSelectThickness))
             return link;
 
@@ -2260,29 +4113,50 @@ int ed::EditorContext::GetNodeIds(NodeId* nodes, int size) const
 
 void ed::EditorContext::RegisterAnimation(Animation* animation)
 {
+    if (animation->m_LiveIndex >= 0)
+        return;
+
+    animation->m_LiveIndex = static_cast<int>(m_LiveAnimations.size());
     m_LiveAnimations.push_back(animation);
 }
 
-void ed::EditorContext::UnregisterAnimation(Animation* animation)
-{
-    auto it = std::find(m_LiveAnimations.begin(), m_LiveAnimations.end(), animation);
-    if (it != m_LiveAnimations.end())
-        m_LiveAnimations.erase(it);
+void ed::EditorContext::UnregisterAnimation(Animation* animation)
+{
+    if (animation->m_LiveIndex < 0)
+        return;
+
+    // Swap with last, order of updates is not important
+    auto last = m_LiveAnimations.back();
+    m_LiveAnimations[animation->m_LiveIndex] = last;
+    last->m_LiveIndex = animation->m_LiveIndex;
+    m_LiveAnimations.pop_back();
+
+    animation->m_LiveIndex = -1;
 }
 
 void ed::EditorContext::UpdateAnimations()
 {
+    // Animations may start or stop each other while being updated, only these
+    // live at the beginning and still live when their turn comes are updated.
     m_LastLiveAnimations = m_LiveAnimations;
 
     for (auto animation : m_LastLiveAnimations)
     {
-        const bool isLive = (std::find(m_LiveAnimations.begin(), m_LiveAnimations.end(), animation) != m_LiveAnimations.end());
-
-        if (isLive)
+        if (animation->m_LiveIndex >= 0)
             animation->Update();
     }
 }
 
+ed::LevelOfDetail ed::EditorContext::CalculateLevelOfDetail(float viewScale) const
+{
+    if (viewScale < m_Style.MinimalDetailZoom)
+        return LevelOfDetail::Minimal;
+    else if (viewScale < m_Style.ReducedDetailZoom)
+        return LevelOfDetail::Reduced;
+    else
+        return LevelOfDetail::Full;
+}
+
 void ed::EditorContext::Flow(Link* link, FlowDirection direction)
 {
     m_FlowAnimationController.Flow(link, direction);
@@ -2320,6 +4194,89 @@ bool ed::EditorContext::AreShortcutsEnabled()
     return m_ShortcutsEnabled;
 }
 
+// Interactive regions of group node in order they are tested for hover.
+static const ed::NodeRegion c_GroupInteractiveRegions[] =
+{
+    ed::NodeRegion::TopLeft,
+    ed::NodeRegion::TopRight,
+    ed::NodeRegion::BottomLeft,
+    ed::NodeRegion::BottomRight,
+    ed::NodeRegion::Top,
+    ed::NodeRegion::Bottom,
+    ed::NodeRegion::Left,
+    ed::NodeRegion::Right,
+    ed::NodeRegion::Header,
+};
+
+ed::Object* ed::EditorContext::FindInteractiveObjectAt(const ImVec2& p, const ImRect& clipRect, NodeRegion& region)
+{
+    region = NodeRegion::None;
+
+    if (!clipRect.Contains(p))
+        return nullptr;
+
+    // Same test ImGui does for invisible button covering rectangle
+    auto isHit = [&p](const ImRect& rect)
+    {
+        const auto size = rect.GetSize();
+        if (size.x <= 0.0f || size.y <= 0.0f)
+            return false;
+
+        return ImRect(rect.Min, rect.Min + size).Contains(p);
+    };
+
+    // Small groups have interactive regions grown past node bounds, see Node::GetRegionBounds().
+    // Bounds narrower than five active areas are expanded by the missing size on each side.
+    const auto activeAreaSize = ImMax(ImMax(
+        GetView().InvScale * c_GroupSelectThickness,
+        m_NodeBuilder.m_MaxGroupBorderWidth), c_GroupSelectThickness);
+    const auto margin = ImVec2(activeAreaSize * 5.0f, activeAreaSize * 5.0f);
+
+    m_NodeQuery.resize(0);
+    m_NodeGrid.Query(ImRect(p - margin, p + margin), m_NodeQuery);
+
+    m_PinQuery.resize(0);
+    m_PinGrid.Query(p, m_PinQuery);
+    for (auto pin : m_PinQuery)
+        if (pin->m_IsLive)
+            m_NodeQuery.push_back(pin->m_Node);
+
+    // Visit candidates front to back, the same order BuildControl() emits widgets in
+    std::sort(m_NodeQuery.begin(), m_NodeQuery.end(), [](const Node* lhs, const Node* rhs)
+    {
+        return lhs->m_Order > rhs->m_Order;
+    });
+    m_NodeQuery.erase(std::unique(m_NodeQuery.begin(), m_NodeQuery.end()), m_NodeQuery.end());
+
+    for (auto node : m_NodeQuery)
+    {
+        if (!node->m_IsLive)
+            continue;
+
+        for (auto pin = node->m_LastPin; pin; pin = pin->m_PreviousPin)
+        {
+            if (pin->m_IsLive && isHit(pin->m_Bounds))
+                return pin;
+        }
+
+        if (node->m_Type == NodeType::Group)
+        {
+            for (auto groupRegion : c_GroupInteractiveRegions)
+            {
+                if (isHit(node->GetRegionBounds(groupRegion)))
+                {
+                    region = groupRegion;
+                    return node;
+                }
+            }
+        }
+        else if (isHit(node->m_Bounds))
+            return node;
+    }
+
+    return nullptr;
+}
+
 ed::Control ed::EditorContext::BuildControl(bool allowOffscreen)
 {
     m_IsHovered = false;
@@ -2423,54 +4380,101 @@ ed::Control ed::EditorContext::BuildControl(bool allowOffscreen)
             activeObject = object;
     };
 
-    // Process live nodes and pins.
-    for (auto nodeIt = m_Nodes.rbegin(), nodeItEnd = m_Nodes.rend(); nodeIt != nodeItEnd; ++nodeIt)
+    // Check for interactions with pin, node or group region.
+    auto checkInteractionsInObject = [&checkInteractionsInArea](Object* object, NodeRegion region)
     {
-        auto node = *nodeIt;
+        if (auto pin = object->AsPin())
+            checkInteractionsInArea(pin->m_ID, pin->m_Bounds, pin);
+        else if (region != NodeRegion::None)
+        {
+            auto node = object->AsNode();
 
-        if (!node->m_IsLive) continue;
+            ImGui::PushID(node->m_ID.AsPointer());
+            checkInteractionsInArea(NodeId(static_cast<int>(region)), node->GetRegionBounds(region), node);
+            ImGui::PopID();
+        }
+        else if (auto node = object->AsNode())
+            checkInteractionsInArea(node->m_ID, node->m_Bounds, node);
+    };
 
-        // Check for interactions with live pins in node before
-        // processing node itself. Pins does not overlap each other
-        // and all are within node bounds.
-        for (auto pin = node->m_LastPin; pin; pin = pin->m_PreviousPin)
-        {
-            if (!pin->m_IsLive) continue;
+    if (m_Config.EnableSingleWidgetHitTest)
+    {
+        // Emit widgets only for object under the mouse and object owning active
+        // widget. Hit test visits objects in the same order widgets are emitted
+        // when every object has one, so ImGui resolves hover and activation to
+        // the same object.
+        NodeRegion hitRegion;
+        auto hitObject = FindInteractiveObjectAt(mousePos, ImGui::GetCurrentWindow()->ClipRect, hitRegion);
 
-            checkInteractionsInArea(pin->m_ID, pin->m_Bounds, pin);
+        auto activeAreaObject = FindObject(m_ActiveAreaObject);
+        auto activeAreaRegion = m_ActiveAreaRegion;
+        if (activeAreaObject && !activeAreaObject->m_IsLive)
+            activeAreaObject = nullptr;
+        if (activeAreaObject && activeAreaRegion != NodeRegion::None)
+        {
+            auto node = activeAreaObject->AsNode();
+            if (!node || node->m_Type != NodeType::Group || ImRect_IsEmpty(node->GetRegionBounds(activeAreaRegion)))
+                activeAreaObject = nullptr;
         }
 
-        // Check for interactions with node.
-        if (node->m_Type == NodeType::Group)
+        m_ActiveAreaObject = ObjectId();
+        m_ActiveAreaRegion = NodeRegion::None;
+
+        auto checkInteractionsInActiveArea = [this, &checkInteractionsInObject](Object* object, NodeRegion region)
         {
-            // Node with a hole
-            ImGui::PushID(node->m_ID.AsPointer());
+            checkInteractionsInObject(object, region);
 
-            static const NodeRegion c_Regions[] =
+            if (ImGui::IsItemActive())
             {
-                NodeRegion::TopLeft,
-                NodeRegion::TopRight,
-                NodeRegion::BottomLeft,
-                NodeRegion::BottomRight,
-                NodeRegion::Top,
-                NodeRegion::Bottom,
-                NodeRegion::Left,
-                NodeRegion::Right,
-                NodeRegion::Header,
-            };
+                m_ActiveAreaObject = object->ID();
+                m_ActiveAreaRegion = region;
+            }
+        };
+
+        if (hitObject)
+            checkInteractionsInActiveArea(hitObject, hitRegion);
+
+        if (activeAreaObject && (activeAreaObject != hitObject || activeAreaRegion != hitRegion))
+            checkInteractionsInActiveArea(activeAreaObject, activeAreaRegion);
+    }
+    else
+    {
+        // Process live nodes and pins.
+        for (auto nodeIt = m_Nodes.rbegin(), nodeItEnd = m_Nodes.rend(); nodeIt != nodeItEnd; ++nodeIt)
+        {
+            auto node = *nodeIt;
+
+            if (!node->m_IsLive) continue;
 
-            for (auto region : c_Regions)
+            // Check for interactions with live pins in node before
+            // processing node itself. Pins does not overlap each other
+            // and all are within node bounds.
+            for (auto pin = node->m_LastPin; pin; pin = pin->m_PreviousPin)
             {
-                auto bounds = node->GetRegionBounds(region);
-                if (ImRect_IsEmpty(bounds))
-                    continue;
-                checkInteractionsInArea(NodeId(static_cast<int>(region)), bounds, node);
+                if (!pin->m_IsLive) continue;
+
+                checkInteractionsInArea(pin->m_ID, pin->m_Bounds, pin);
             }
 
-            ImGui::PopID();
+            // Check for interactions with node.
+            if (node->m_Type == NodeType::Group)
+            {
+                // Node with a hole
+                ImGui::PushID(node->m_ID.AsPointer());
+
+                for (auto region : c_GroupInteractiveRegions)
+                {
+                    auto bounds = node->GetRegionBounds(region);
+                    if (ImRect_IsEmpty(bounds))
+                        continue;
+                    checkInteractionsInArea(NodeId(static_cast<int>(region)), bounds, node);
+                }
+
+                ImGui::PopID();
+            }
+            else
+                checkInteractionsInArea(node->m_ID, node->m_Bounds, node);
         }
-        else
-            checkInteractionsInArea(node->m_ID, node->m_Bounds, node);
     }
 
     // Links are not regular widgets and must be done manually since
@@ -2629,6 +4633,19 @@ void ed::EditorContext::ShowMetrics(const Control& control)
     ImGui::Text("Live Nodes: %d", liveNodeCount);
     ImGui::Text("Live Pins: %d", livePinCount);
     ImGui::Text("Live Links: %d", liveLinkCount);
+    auto showPoolStats = [](const char* name, const auto& stats)
+    {
+        ImGui::Text("%s Pool: %d allocated, %d peak, %d capacity", name, stats.Live, stats.HighWaterMark, stats.Capacity);
+    };
+    showPoolStats("Node", m_NodePool.GetStats());
+    showPoolStats("Pin",  m_PinPool.GetStats());
+    showPoolStats("Link", m_LinkPool.GetStats());
+    ImGui::Text("Shape Templates: %d", m_ShapeCache.GetTemplateCount());
+    if (m_Config.LinkTessellationBudget > 0)
+        ImGui::Text("Link Points: %d of %d", m_LinkBatcher.GetLastPointCount(), m_Config.LinkTessellationBudget);
+    else
+        ImGui::Text("Link Points: %d", m_LinkBatcher.GetLastPointCount());
+    ImGui::Text("Reused Frames: %d of %d, %d drawn with margin", m_ReusedFrameCount, m_FrameCount, m_MarginFrameCount);
     ImGui::Text("Hot Object: %s (%p)", getHotObjectName(), control.HotObject ? control.HotObject->ID().AsPointer() : nullptr);
     if (auto node = control.HotObject ? control.HotObject->AsNode() : nullptr)
     {
@@ -2738,19 +4755,26 @@ bool ed::NodeSettings::Parse(const json::value& data, NodeSettings& result)
 // Settings
 //
 //------------------------------------------------------------------------------
+ed::Settings::~Settings()
+{
+    for (auto settings : m_Nodes)
+        m_NodePool.Destroy(settings);
+}
+
 ed::NodeSettings* ed::Settings::AddNode(NodeId id)
 {
-    m_Nodes.push_back(NodeSettings(id));
-    return &m_Nodes.back();
+    IM_ASSERT(nullptr == FindNode(id));
+
+    auto settings = m_NodePool.Create(id);
+    m_Nodes.push_back(settings);
+    m_NodeIndex.Insert(id, settings);
+
+    return settings;
 }
 
 ed::NodeSettings* ed::Settings::FindNode(NodeId id)
 {
-    for (auto& settings : m_Nodes)
-        if (settings.m_ID == id)
-            return &settings;
-
-    return nullptr;
+    return m_NodeIndex.Find(id);
 }
 
 void ed::Settings::RemoveNode(NodeId id)
@@ -2775,8 +4799,8 @@ void ed::Settings::ClearDirty(Node* node)
         m_IsDirty     = false;
         m_DirtyReason = SaveReasonFlags::None;
 
-        for (auto& knownNode : m_Nodes)
-            knownNode.ClearDirty();
+        for (auto knownNode : m_Nodes)
+            knownNode->ClearDirty();
     }
 }
 
@@ -2812,10 +4836,10 @@ std::string ed::Settings::Serialize()
     };
 
     auto& nodes = result["nodes"];
-    for (auto& node : m_Nodes)
+    for (auto node : m_Nodes)
     {
-        if (node.m_WasUsed)
-            nodes[serializeObjectId(node.m_ID)] = node.Serialize();
+        if (node->m_WasUsed)
+            nodes[serializeObjectId(node->m_ID)] = node->Serialize();
     }
 
     auto& selection = result["selection"];
@@ -2834,10 +4858,9 @@ std::string ed::Settings::Serialize()
     return result.dump();
 }
 
-bool ed::Settings::Parse(const std::string& string, Settings& settings)
+bool ed::Settings::Parse(const std::string& string, Settings& result)
 {
-    Settings result = settings;
-
+    // Settings are updated in place, nothing is touched until document is known to be valid.
     auto settingsValue = json::value::parse(string);
     if (settingsValue.is_discarded())
         return false;
@@ -2926,8 +4949,6 @@ bool ed::Settings::Parse(const std::string& string, Settings& settings)
             result.m_VisibleRect = {};
     }
 
-    settings = std::move(result);
-
     return true;
 }
 
@@ -2942,7 +4963,8 @@ ed::Animation::Animation(EditorContext* editor):
     Editor(editor),
     m_State(Stopped),
     m_Time(0.0f),
-    m_Duration(0.0f)
+    m_Duration(0.0f),
+    m_LiveIndex(-1)
 {
 }
 
@@ -3078,7 +5100,8 @@ ed::FlowAnimation::FlowAnimation(FlowAnimationController* controller):
     Controller(controller),
     m_Link(nullptr),
     m_Offset(0.0f),
-    m_PathLength(0.0f)
+    m_ControllerIndex(-1),
+    m_IsPooled(false)
 {
 }
 
@@ -3088,13 +5111,14 @@ void ed::FlowAnimation::Flow(ed::Link* link, float markerDistance, float speed,
 
     if (m_Link != link)
     {
+        if (m_Link)
+            m_Link->m_FlowAnimation = nullptr;
+
+        link->m_FlowAnimation = this;
+
         m_Offset = 0.0f;
-        ClearPath();
     }
 
-    if (m_MarkerDistance != markerDistance)
-        ClearPath();
-
     m_MarkerDistance = markerDistance;
     m_Speed          = speed;
     m_Link           = link;
@@ -3102,17 +5126,28 @@ void ed::FlowAnimation::Flow(ed::Link* link, float markerDistance, float speed,
     Play(duration);
 }
 
-void ed::FlowAnimation::Draw(ImDrawList* drawList)
+void ed::FlowAnimation::DetachLink()
 {
-    if (!IsPlaying() || !IsLinkValid() || !m_Link->IsVisible())
+    if (!m_Link)
         return;
 
-    if (!IsPathValid())
-        UpdatePath();
+    m_Link->m_FlowAnimation = nullptr;
+    m_Link = nullptr;
+
+    Stop();
+}
+
+void ed::FlowAnimation::DrawLink(LinkBatcher& linkBatcher)
+{
+    if (!IsPlaying() || !IsLinkValid() || !m_Link->IsVisible())
+        return;
 
-    m_Offset = fmodf(m_Offset, m_MarkerDistance);
+    // Offset wraps at period of sparsest markers, so thinned out markers
+    // move without jumps
+    const auto period = m_MarkerDistance * c_FlowMarkerMaxThinning;
+    m_Offset = fmodf(m_Offset, period);
     if (m_Offset < 0)
-        m_Offset += m_MarkerDistance;
+        m_Offset += period;
 
     const auto progress    = GetProgress();
 
@@ -3120,77 +5155,69 @@ void ed::FlowAnimation::Draw(ImDrawList* drawList)
     const auto flowColor = Editor->GetColor(StyleColor_Flow, flowAlpha);
     //const auto flowPath  = Link->GetCurve();
 
-    m_Link->Draw(drawList, flowColor, 2.0f);
-
-    if (IsPathValid())
-    {
-        //Offset = 0;
-
-        const auto markerAlpha  = powf(1.0f - progress, 0.35f);
-        const auto markerRadius = 4.0f * (1.0f - progress) + 2.0f;
-        const auto markerColor  = Editor->GetColor(StyleColor_FlowMarker, markerAlpha);
-
-        for (float d = m_Offset; d < m_PathLength; d += m_MarkerDistance)
-            drawList->AddCircleFilled(SamplePath(d), markerRadius, markerColor);
-    }
+    linkBatcher.Add(c_LinkChannel_Flow, m_Link, flowColor, 2.0f);
 }
 
-bool ed::FlowAnimation::IsLinkValid() const
+// Number of segments keeping circle of given radius within max error, both in
+// screen pixels. Small circles end up as quads.
+static inline int ImCircleSegmentCount(float radius, float maxError)
 {
-    return m_Link && m_Link->m_IsLive;
-}
+    if (radius <= maxError)
+        return 4;
 
-bool ed::FlowAnimation::IsPathValid() const
-{
-    return m_Path.size() > 1 && m_PathLength > 0.0f && m_Link->m_Start == m_LastStart && m_Link->m_End == m_LastEnd;
+    const auto count = static_cast<int>(ImCeil(IM_PI / ImAcos(1.0f - maxError / radius)));
+
+    return ImClamp((count + 1) & ~1, 4, 64);
 }
 
-void ed::FlowAnimation::UpdatePath()
+void ed::FlowAnimation::DrawMarkers(ImDrawList* drawList)
 {
-    if (!IsLinkValid())
-    {
-        ClearPath();
+    if (!IsPlaying() || !IsLinkValid() || !m_Link->IsVisible())
         return;
-    }
 
-    const auto curve  = m_Link->GetCurve();
+    const auto& path = m_Link->GetArcLengthTable();
+    if (path.GetLength() <= 0.0f || m_MarkerDistance <= 0.0f)
+        return;
+
+    const auto progress     = GetProgress();
+    const auto markerAlpha  = powf(1.0f - progress, 0.35f);
+    const auto markerRadius = 4.0f * (1.0f - progress) + 2.0f;
+    const auto markerColor  = Editor->GetColor(StyleColor_FlowMarker, markerAlpha);
+
+    // Zoomed out markers are thinned out to every second, fourth, ... one, so
+    // they do not pile up on screen
+    const auto& view = Editor->GetView();
+    auto markerStep = m_MarkerDistance;
+    for (int thinning = 1; thinning < c_FlowMarkerMaxThinning && markerStep * view.Scale < c_FlowMarkerMinSpacing; thinning *= 2)
+        markerStep *= 2.0f;
 
-    m_LastStart  = m_Link->m_Start;
-    m_LastEnd    = m_Link->m_End;
-    m_PathLength = ImCubicBezierLength(curve.P0, curve.P1, curve.P2, curve.P3);
+    // Markers outside of clip rectangle are not emitted at all
+    auto clipRect = ImRect(drawList->GetClipRectMin(), drawList->GetClipRectMax());
+    clipRect.Expand(markerRadius);
 
-    auto collectPointsCallback = [this](ImCubicBezierFixedStepSample& result)
+    auto& points = Controller->GetMarkerBuffer();
+    points.resize(0);
+
+    for (float d = fmodf(m_Offset, markerStep); d < path.GetLength(); d += markerStep)
     {
-        m_Path.push_back(CurvePoint{ result.Length, result.Point });
-    };
+        const auto point = path.SamplePoint(d);
+        if (clipRect.Contains(point))
+            points.push_back(point);
+    }
 
-    const auto step = ImMax(m_MarkerDistance * 0.5f, 15.0f);
+    const auto segmentCount = ImCircleSegmentCount(markerRadius * view.Scale, c_FlowMarkerMaxError);
 
-    m_Path.resize(0);
-    ImCubicBezierFixedStep(collectPointsCallback, curve, step, false, 0.5f, 0.001f);
+    Controller->DrawMarkers(drawList, points.data(), static_cast<int>(points.size()), markerRadius, segmentCount, markerColor);
 }
 
-void ed::FlowAnimation::ClearPath()
+bool ed::FlowAnimation::IsLinkValid() const
 {
-    vector<CurvePoint>().swap(m_Path);
-    m_PathLength = 0.0f;
+    return m_Link && m_Link->m_IsLive;
 }
 
-ImVec2 ed::FlowAnimation::SamplePath(float distance) const
+void ed::FlowAnimation::OnPlay()
 {
-    //distance = ImMax(0.0f, std::min(distance, PathLength));
-
-    auto endPointIt = std::find_if(m_Path.begin(), m_Path.end(), [distance](const CurvePoint& p) { return distance < p.Distance; });
-    if (endPointIt == m_Path.end())
-        endPointIt = m_Path.end() - 1;
-    else if (endPointIt == m_Path.begin())
-        endPointIt = m_Path.begin() + 1;
-
-    const auto& start = endPointIt[-1];
-    const auto& end   = *endPointIt;
-    const auto  t     = (distance - start.Distance) / (end.Distance - start.Distance);
-
-    return start.Point + (end.Point - start.Point) * t;
+    Controller->Activate(this);
 }
 
 void ed::FlowAnimation::OnUpdate(float progress)
@@ -3242,29 +5269,147 @@ void ed::FlowAnimationController::Flow(Link* link, FlowDirection direction)
 
 void ed::FlowAnimationController::Draw(ImDrawList* drawList)
 {
-    if (m_Animations.empty())
+    if (m_LiveAnimations.empty())
         return;
 
     drawList->ChannelsSetCurrent(c_LinkChannel_Flow);
 
-    for (auto animation : m_Animations)
-        animation->Draw(drawList);
+    // Links of all animations are emitted in one batch, markers go on top
+    auto& linkBatcher = Editor->GetLinkBatcher();
+    for (auto animation : m_LiveAnimations)
+        animation->DrawLink(linkBatcher);
+    linkBatcher.Flush(drawList);
+
+    for (auto animation : m_LiveAnimations)
+        animation->DrawMarkers(drawList);
 }
 
-ed::FlowAnimation* ed::FlowAnimationController::GetOrCreate(Link* link)
+void ed::FlowAnimationController::Activate(FlowAnimation* animation)
+{
+    if (animation->m_ControllerIndex >= 0)
+        return;
+
+    animation->m_ControllerIndex = static_cast<int>(m_LiveAnimations.size());
+    m_LiveAnimations.push_back(animation);
+}
+
+void ed::FlowAnimationController::Release(FlowAnimation* animation)
+{
+    if (animation->m_ControllerIndex < 0)
+        return;
+
+    auto last = m_LiveAnimations.back();
+    m_LiveAnimations[animation->m_ControllerIndex] = last;
+    last->m_ControllerIndex = animation->m_ControllerIndex;
+    m_LiveAnimations.pop_back();
+
+    animation->m_ControllerIndex = -1;
+
+    if (!animation->m_IsPooled)
+    {
+        animation->m_IsPooled = true;
+        m_FreePool.push_back(animation);
+    }
+}
+
+void ed::FlowAnimationController::DrawMarkers(ImDrawList* drawList, const ImVec2* points, int count, float radius, int segmentCount, ImU32 color)
 {
-    // Return live animation which match target link
+    if (count <= 0 || (color & IM_COL32_A_MASK) == 0)
+        return;
+
+    // All markers of one flow share radius and color. First one is tessellated
+    // by ImGui, rest is stamped from it.
+    const auto vtxStart      = drawList->VtxBuffer.Size;
+    const auto idxStart      = drawList->IdxBuffer.Size;
+    const auto vtxIndexStart = drawList->_VtxCurrentIdx;
+    const auto vtxOffset     = drawList->_CmdHeader.VtxOffset;
+
+    drawList->AddCircleFilled(points[0], radius, color, segmentCount);
+
+    if (count == 1)
+        return;
+
+    if (drawList->_CmdHeader.VtxOffset != vtxOffset)
+    {
+        for (int i = 1; i < count; ++i)
+            drawList->AddCircleFilled(points[i], radius, color, segmentCount);
+        return;
+    }
+
+    const auto vtxCount = drawList->VtxBuffer.Size - vtxStart;
+    const auto idxCount = drawList->IdxBuffer.Size - idxStart;
+
+    m_MarkerVertices.resize(vtxCount);
+    for (int i = 0; i < vtxCount; ++i)
+    {
+        m_MarkerVertices[i] = drawList->VtxBuffer[vtxStart + i];
+        m_MarkerVertices[i].pos -= points[0];
+    }
+
+    m_MarkerIndices.resize(idxCount);
+    for (int i = 0; i < idxCount; ++i)
+        m_MarkerIndices[i] = static_cast<ImDrawIdx>(drawList->IdxBuffer[idxStart + i] - vtxIndexStart);
+
+    // Reserve in chunks, with 16-bit indices single reservation cannot span
+    // more than 64k vertices
+    const auto chunkSize = ImMax(1, 16384 / ImMax(1, vtxCount));
+    for (int first = 1; first < count; first += chunkSize)
     {
-        auto animationIt = std::find_if(m_Animations.begin(), m_Animations.end(), [link](FlowAnimation* animation) { return animation->m_Link == link; });
-        if (animationIt != m_Animations.end())
-            return *animationIt;
+        const auto chunkCount = ImMin(chunkSize, count - first);
+
+        drawList->PrimReserve(idxCount * chunkCount, vtxCount * chunkCount);
+
+        auto vtx = drawList->_VtxWritePtr;
+        auto idx = drawList->_IdxWritePtr;
+        auto base = drawList->_VtxCurrentIdx;
+
+        for (int i = first; i < first + chunkCount; ++i)
+        {
+            const auto& point = points[i];
+
+            for (int j = 0; j < vtxCount; ++j, ++vtx)
+            {
+                const auto& vertex = m_MarkerVertices[j];
+                vtx->pos = vertex.pos + point;
+                vtx->uv  = vertex.uv;
+                vtx->col = vertex.col;
+            }
+
+            for (int j = 0; j < idxCount; ++j)
+                *idx++ = static_cast<ImDrawIdx>(m_MarkerIndices[j] + base);
+
+            base += vtxCount;
+        }
+
+        drawList->_VtxWritePtr   = vtx;
+        drawList->_IdxWritePtr   = idx;
+        drawList->_VtxCurrentIdx = base;
     }
+}
+
+ed::FlowAnimation* ed::FlowAnimationController::GetOrCreate(Link* link)
+{
+    // Return animation last played on target link, keeps markers continuous
+    if (link->m_FlowAnimation)
+        return link->m_FlowAnimation;
 
-    // There are no live animations for target link, try to reuse inactive old one
-    if (!m_FreePool.empty())
+    // There are no animations for target link, try to reuse stopped one
+    while (!m_FreePool.empty())
     {
         auto animation = m_FreePool.back();
         m_FreePool.pop_back();
+        animation->m_IsPooled = false;
+
+        // Animation was played again on its link after being pooled
+        if (animation->IsPlaying())
+            continue;
+
+        if (animation->m_Link)
+        {
+            animation->m_Link->m_FlowAnimation = nullptr;
+            animation->m_Link = nullptr;
+        }
+
         return animation;
     }
 
@@ -3275,11 +5420,6 @@ ed::FlowAnimation* ed::FlowAnimationController::GetOrCreate(Link* link)
     return animation;
 }
 
-void ed::FlowAnimationController::Release(FlowAnimation* animation)
-{
-    IM_UNUSED(animation);
-}
-
 
 
 //------------------------------------------------------------------------------
@@ -3809,6 +5949,7 @@ bool ed::SizeAction::Process(const Control& control)
         m_SizedNode->m_GroupBounds.Min.y -= m_StartBounds.Min.y - m_StartGroupBounds.Min.y;
         m_SizedNode->m_GroupBounds.Max.x -= m_StartBounds.Max.x - m_StartGroupBounds.Max.x;
         m_SizedNode->m_GroupBounds.Max.y -= m_StartBounds.Max.y - m_StartGroupBounds.Max.y;
+        Editor->UpdateNodeGrid(m_SizedNode);
     }
     else if (!control.ActiveNode)
     {
@@ -5190,7 +7331,11 @@ ed::Object* ed::DeleteItemsAction::DropCurrentItem()
 ed::NodeBuilder::NodeBuilder(EditorContext* editor):
     Editor(editor),
     m_CurrentNode(nullptr),
-    m_CurrentPin(nullptr)
+    m_CurrentPin(nullptr),
+    m_MaxGroupBorderWidth(0.0f),
+    m_IsContentReplayed(false),
+    m_IsContentRecorded(false),
+    m_ContentSegmentCount(0)
 {
 }
 
@@ -5201,9 +7346,21 @@ ed::NodeBuilder::~NodeBuilder()
 }
 
 void ed::NodeBuilder::Begin(NodeId nodeId)
+{
+    BeginNode(nodeId, false, 0);
+}
+
+bool ed::NodeBuilder::Begin(NodeId nodeId, int contentVersion)
+{
+    return BeginNode(nodeId, true, contentVersion);
+}
+
+bool ed::NodeBuilder::BeginNode(NodeId nodeId, bool isVersioned, int contentVersion)
 {
     IM_ASSERT(nullptr == m_CurrentNode);
 
+    Editor->CancelFrameReuse();
+
     m_CurrentNode = Editor->GetNode(nodeId);
 
     Editor->UpdateNodeState(m_CurrentNode);
@@ -5225,6 +7382,7 @@ void ed::NodeBuilder::Begin(NodeId nodeId)
                 {
                     node->m_Bounds.Translate(ImFloor(offset));
                     node->m_GroupBounds.Translate(ImFloor(offset));
+                    Editor->UpdateNodeGrid(node);
                     Editor->MakeDirty(SaveReasonFlags::Position | SaveReasonFlags::User, node);
                 }
             }
@@ -5232,6 +7390,7 @@ void ed::NodeBuilder::Begin(NodeId nodeId)
             {
                 m_CurrentNode->m_Bounds.Translate(ImFloor(offset));
                 m_CurrentNode->m_GroupBounds.Translate(ImFloor(offset));
+                Editor->UpdateNodeGrid(m_CurrentNode);
                 Editor->MakeDirty(SaveReasonFlags::Position | SaveReasonFlags::User, m_CurrentNode);
             }
         }
@@ -5247,7 +7406,6 @@ void ed::NodeBuilder::Begin(NodeId nodeId)
     const auto alpha = ImGui::GetStyle().Alpha;
 
     m_CurrentNode->m_IsLive           = true;
-    m_CurrentNode->m_LastPin          = nullptr;
     m_CurrentNode->m_Color            = Editor->GetColor(StyleColor_NodeBg, alpha);
     m_CurrentNode->m_BorderColor      = Editor->GetColor(StyleColor_NodeBorder, alpha);
     m_CurrentNode->m_BorderWidth      = editorStyle.NodeBorderWidth;
@@ -5260,12 +7418,36 @@ void ed::NodeBuilder::Begin(NodeId nodeId)
 
     m_IsGroup = false;
 
-    // Grow channel list and select user channel
-    if (auto drawList = Editor->GetDrawList())
+    auto drawList = Editor->GetDrawList();
+
+    m_IsContentReplayed = isVersioned && m_CurrentNode->m_ContentVersion == contentVersion && CanReplayContent(drawList);
+    m_IsContentRecorded = isVersioned && !m_IsContentReplayed && drawList != nullptr;
+
+    m_CurrentNode->m_ContentVersion = contentVersion;
+    if (!isVersioned)
+        m_CurrentNode->m_ContentCache.Clear();
+
+    if (m_IsContentReplayed)
+    {
+        // Pins are not submitted, ones from last time move together with the node
+        const auto offset = m_CurrentNode->m_Bounds.Min - m_CurrentNode->m_ContentOrigin;
+        for (auto pin = m_CurrentNode->m_LastPin; pin; pin = pin->m_PreviousPin)
+        {
+            pin->m_IsLive = true;
+            pin->m_Bounds.Translate(offset);
+            pin->m_Pivot.Translate(offset);
+            Editor->UpdatePinGrid(pin);
+        }
+    }
+    else
+        m_CurrentNode->m_LastPin = nullptr;
+
+    m_CurrentNode->m_ContentOrigin = m_CurrentNode->m_Bounds.Min;
+
+    // Select user layer
+    if (drawList)
     {
-        m_CurrentNode->m_Channel = drawList->_Splitter._Count;
-        ImDrawList_ChannelsGrow(drawList, drawList->_Splitter._Count + c_ChannelsPerNode);
-        drawList->ChannelsSetCurrent(m_CurrentNode->m_Channel + c_NodeContentChannel);
+        Editor->SetNodeLayer(drawList, m_CurrentNode, c_NodeLayer_Content);
 
         m_Splitter.Clear();
         ImDrawList_SwapSplitter(drawList, m_Splitter);
@@ -5280,6 +7462,20 @@ void ed::NodeBuilder::Begin(NodeId nodeId)
         ImGui::SetCursorPos(ImGui::GetCursorPos() + ImVec2(editorStyle.NodePadding.x, editorStyle.NodePadding.y));
         ImGui::BeginGroup();
     }
+
+    if (m_IsContentReplayed)
+    {
+        // Stand-in for user content, node gets the same size
+        m_CurrentNode->m_ContentCache.Replay(drawList, m_CurrentNode->m_Bounds.Min);
+        ImGui::Dummy(m_CurrentNode->m_ContentSize);
+    }
+    else if (m_IsContentRecorded)
+    {
+        m_ContentMark         = NodeContentCache::Begin(drawList);
+        m_ContentSegmentCount = Editor->GetNodeLayers().GetSegmentCount();
+    }
+
+    return !m_IsContentReplayed;
 }
 
 void ed::NodeBuilder::End()
@@ -5292,12 +7488,16 @@ void ed::NodeBuilder::End()
         ImDrawList_SwapSplitter(drawList, m_Splitter);
     }
 
+    ImVec2 contentSize;
+
     // Apply frame padding. This must be done in this convoluted way if outer group
     // size must contain inner group padding.
     auto& editorStyle = Editor->GetStyle();
-    if (editorStyle.NodePadding.x != 0 || editorStyle.NodePadding.y != 0 || editorStyle.NodePadding.z != 0 || editorStyle.NodePadding.w != 0)
+    const auto hasPadding = editorStyle.NodePadding.x != 0 || editorStyle.NodePadding.y != 0 || editorStyle.NodePadding.z != 0 || editorStyle.NodePadding.w != 0;
+    if (hasPadding)
     {
         ImGui::EndGroup();
+        contentSize = ImGui::GetItemRectSize();
         ImGui::SameLine(0, editorStyle.NodePadding.z);
         ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0.0f, 0.0f));
         ImGui::Dummy(ImVec2(0, 0)); // bump cursor at the end of the line and move to next one
@@ -5308,12 +7508,16 @@ void ed::NodeBuilder::End()
     // End outer group.
     ImGui::EndGroup();
 
+    if (!hasPadding)
+        contentSize = ImGui::GetItemRectSize();
+
     m_NodeRect = ImGui_GetItemRect();
     m_NodeRect.Floor();
 
     if (m_CurrentNode->m_Bounds.GetSize() != m_NodeRect.GetSize())
     {
         m_CurrentNode->m_Bounds.Max = m_CurrentNode->m_Bounds.Min + m_NodeRect.GetSize();
+        Editor->UpdateNodeGrid(m_CurrentNode);
         Editor->MakeDirty(SaveReasonFlags::Size, m_CurrentNode);
     }
 
@@ -5326,10 +7530,32 @@ void ed::NodeBuilder::End()
         m_CurrentNode->m_Type        = NodeType::Group;
         m_CurrentNode->m_GroupBounds = m_GroupBounds;
         m_CurrentNode->m_LastPin     = nullptr;
+
+        m_MaxGroupBorderWidth = ImMax(m_MaxGroupBorderWidth, m_CurrentNode->m_GroupBorderWidth);
     }
     else
         m_CurrentNode->m_Type        = NodeType::Node;
 
+    if (m_IsContentRecorded)
+    {
+        // Content is reused only if it was drawn whole, ImGui skips items and
+        // text lines outside of the clip rectangle.
+        auto  drawList   = Editor->GetDrawList();
+        auto& nodeLayers = Editor->GetNodeLayers();
+        const auto canStore = !m_IsGroup
+            && nodeLayers.GetSegmentCount() == m_ContentSegmentCount
+            && nodeLayers.IsCurrent(m_CurrentNode, c_NodeLayer_Content)
+            && ImRect(m_ContentMark.m_ClipRect).Contains(m_CurrentNode->m_Bounds);
+
+        if (!canStore || !m_CurrentNode->m_ContentCache.Store(drawList, m_ContentMark, m_CurrentNode->m_Bounds.Min))
+            m_CurrentNode->m_ContentCache.Clear();
+
+        m_CurrentNode->m_ContentSize = contentSize;
+    }
+
+    m_IsContentReplayed = false;
+    m_IsContentRecorded = false;
+
     m_CurrentNode = nullptr;
 }
 
@@ -5390,6 +7616,8 @@ void ed::NodeBuilder::EndPin()
     if (m_ResolvePinRect)
         m_CurrentPin->m_Bounds = ImGui_GetItemRect();
 
+    Editor->UpdatePinGrid(m_CurrentPin);
+
     if (m_ResolvePivot)
     {
         auto& pinRect = m_CurrentPin->m_Bounds;
@@ -5475,18 +7703,63 @@ ImDrawList* ed::NodeBuilder::GetUserBackgroundDrawList() const
     return GetUserBackgroundDrawList(m_CurrentNode);
 }
 
+bool ed::NodeBuilder::BeginEditorSplitter(ImDrawList* drawList)
+{
+    // Channels split by user cannot be stepped over
+    if (nullptr == m_CurrentNode || drawList->_Splitter._Count != 1)
+        return false;
+
+    // Geometry drawn while canvas is suspended is in screen space, it cannot be replayed
+    m_IsContentRecorded = false;
+
+    if (m_CurrentPin)
+    {
+        if (m_PinSplitter._Count != 1)
+            return false;
+
+        ImDrawList_SwapSplitter(drawList, m_PinSplitter);
+    }
+
+    ImDrawList_SwapSplitter(drawList, m_Splitter);
+
+    return true;
+}
+
+void ed::NodeBuilder::EndEditorSplitter(ImDrawList* drawList)
+{
+    ImDrawList_SwapSplitter(drawList, m_Splitter);
+
+    if (m_CurrentPin)
+        ImDrawList_SwapSplitter(drawList, m_PinSplitter);
+}
+
 ImDrawList* ed::NodeBuilder::GetUserBackgroundDrawList(Node* node) const
 {
+    Editor->CancelFrameReuse();
+
     if (node && node->m_IsLive)
     {
         auto drawList = Editor->GetDrawList();
-        drawList->ChannelsSetCurrent(node->m_Channel + c_NodeUserBackgroundChannel);
+        Editor->SetNodeLayer(drawList, node, c_NodeLayer_UserBackground);
         return drawList;
     }
     else
         return nullptr;
 }
 
+bool ed::NodeBuilder::CanReplayContent(ImDrawList* drawList) const
+{
+    if (!drawList || IsGroup(m_CurrentNode) || !m_CurrentNode->m_ContentCache.IsValid(drawList))
+        return false;
+
+    // Pin submitted by other node in the meantime belongs to it now
+    for (auto pin = m_CurrentNode->m_LastPin; pin; pin = pin->m_PreviousPin)
+        if (pin->m_Node != m_CurrentNode || pin->m_IsLive)
+            return false;
+
+    return true;
+}
+
 
 
 
@@ -5729,6 +8002,8 @@ float* ed::Style::GetVarFloatAddr(StyleVar idx)
         case StyleVar_SnapLinkToPinDir:         return &SnapLinkToPinDir;
         case StyleVar_HoveredNodeBorderOffset:  return &HoverNodeBorderOffset;
         case StyleVar_SelectedNodeBorderOffset: return &SelectedNodeBorderOffset;
+        case StyleVar_ReducedDetailZoom:        return &ReducedDetailZoom;
+        case StyleVar_MinimalDetailZoom:        return &MinimalDetailZoom;
         default:                                return nullptr;
     }
 }
@@ -64,6 +64,13 @@ enum class CanvasSizeMode
 
 
 //------------------------------------------------------------------------------
+enum class LevelOfDetail
+{
+    Full,       // Everything is drawn
+    Reduced,    // Links are straight lines without arrows, pins are not highlighted
+    Minimal     // Nodes are flat rectangles without user content
+};
+
 enum class SaveReasonFlags: uint32_t
 {
     None       = 0x00000000,
@@ -107,6 +114,8 @@ struct Config
     int                     ContextMenuButtonIndex; // Mouse button index context menu action will react to (0-left, 1-right, 2-middle)
     bool                    EnableSmoothZoom;
     float                   SmoothZoomPower;
+    bool                    EnableSingleWidgetHitTest; // Find object under mouse with editor hit test and submit ImGui items only for hovered and active object
+    int                     LinkTessellationBudget; // Max number of points links are tessellated into per frame, links over budget use coarser tolerance, 0 for no limit
 
     Config()
         : SettingsFile("NodeEditor.json")
@@ -129,6 +138,8 @@ struct Config
 # else
         , SmoothZoomPower(1.3f)
 # endif
+        , EnableSingleWidgetHitTest(true)
+        , LinkTessellationBudget(0)
     {
     }
 };
@@ -189,6 +200,8 @@ enum StyleVar
     StyleVar_SnapLinkToPinDir,
     StyleVar_HoveredNodeBorderOffset,
     StyleVar_SelectedNodeBorderOffset,
+    StyleVar_ReducedDetailZoom,
+    StyleVar_MinimalDetailZoom,
 
     StyleVar_Count
 };
@@ -222,6 +235,8 @@ struct Style
     float   GroupBorderWidth;
     float   HighlightConnectedLinks;
     float   SnapLinkToPinDir; // when true link will start on the line defined by pin direction
+    float   ReducedDetailZoom; // view scale below which LevelOfDetail::Reduced is used, 0 to disable
+    float   MinimalDetailZoom; // view scale below which LevelOfDetail::Minimal is used, 0 to disable
     ImVec4  Colors[StyleColor_Count];
 
     Style()
@@ -257,6 +272,8 @@ struct Style
         GroupBorderWidth         = 1.0f;
         HighlightConnectedLinks  = 0.0f;
         SnapLinkToPinDir         = 0.0f;
+        ReducedDetailZoom        = 0.0f;
+        MinimalDetailZoom        = 0.0f;
 
         Colors[StyleColor_Bg]                 = ImColor( 60,  60,  70, 200);
         Colors[StyleColor_Grid]               = ImColor(120, 120, 120,  40);
@@ -305,8 +322,10 @@ IMGUI_NODE_EDITOR_API void PopStyleVar(int count = 1);
 
 IMGUI_NODE_EDITOR_API void Begin(const char* id, const ImVec2& size = ImVec2(0, 0));
 IMGUI_NODE_EDITOR_API void End();
+IMGUI_NODE_EDITOR_API bool CanReuseFrame(); // Returns true if nothing but the view changed since last frame. Nodes and links may be skipped until End(), previous frame is drawn instead. Submitting any of them draws frame as usual
 
 IMGUI_NODE_EDITOR_API void BeginNode(NodeId id);
+IMGUI_NODE_EDITOR_API bool BeginNode(NodeId id, int contentVersion); // Returns true if node content must be submitted. Otherwise content drawn last time with the same version is reused, EndNode() must be called in both cases
 IMGUI_NODE_EDITOR_API void BeginPin(PinId id, PinKind kind);
 IMGUI_NODE_EDITOR_API void PinRect(const ImVec2& a, const ImVec2& b);
 IMGUI_NODE_EDITOR_API void PinPivotRect(const ImVec2& a, const ImVec2& b);
@@ -384,6 +403,8 @@ IMGUI_NODE_EDITOR_API bool HasAnyLinks(NodeId nodeId); // Returns true if node h
 IMGUI_NODE_EDITOR_API bool HasAnyLinks(PinId pinId); // Return true if pin has any link connected
 IMGUI_NODE_EDITOR_API int BreakLinks(NodeId nodeId); // Break all links connected to this node
 IMGUI_NODE_EDITOR_API int BreakLinks(PinId pinId); // Break all links connected to this pin
+IMGUI_NODE_EDITOR_API int GetNodeLinks(NodeId nodeId, LinkId* links, int size); // Fills an array with id's of links connected to this node; up to 'size' elements are set. Returns actual size of filled id's, or total count if 'links' is nullptr.
+IMGUI_NODE_EDITOR_API int GetPinLinks(PinId pinId, LinkId* links, int size); // Fills an array with id's of links connected to this pin; up to 'size' elements are set. Returns actual size of filled id's, or total count if 'links' is nullptr.
 
 IMGUI_NODE_EDITOR_API void NavigateToContent(float duration = -1);
 IMGUI_NODE_EDITOR_API void NavigateToSelection(bool zoomIn = false, float duration = -1);
@@ -408,6 +429,7 @@ IMGUI_NODE_EDITOR_API int  GetActionContextLinks(LinkId* links, int size);
 IMGUI_NODE_EDITOR_API void EndShortcut();
 
 IMGUI_NODE_EDITOR_API float GetCurrentZoom();
+IMGUI_NODE_EDITOR_API LevelOfDetail GetLevelOfDetail();
 
 IMGUI_NODE_EDITOR_API NodeId GetHoveredNode();
 IMGUI_NODE_EDITOR_API PinId GetHoveredPin();
@@ -421,6 +443,8 @@ IMGUI_NODE_EDITOR_API ImGuiMouseButton GetBackgroundClickButtonIndex(); // -1 if
 IMGUI_NODE_EDITOR_API ImGuiMouseButton GetBackgroundDoubleClickButtonIndex(); // -1 if none
 
 IMGUI_NODE_EDITOR_API bool GetLinkPins(LinkId linkId, PinId* startPinId, PinId* endPinId); // pass nullptr if particular pin do not interest you
+IMGUI_NODE_EDITOR_API float GetLinkLength(LinkId linkId); // Returns length of link curve in canvas space, 0 if link does not exist.
+IMGUI_NODE_EDITOR_API bool SampleLink(LinkId linkId, float distance, ImVec2* point, ImVec2* tangent = nullptr); // Point and unit tangent at given distance along the link in canvas space. Distance is clamped to link length. Useful for labels and decorations.
 
 IMGUI_NODE_EDITOR_API bool PinHadAnyLinks(PinId pinId);
 
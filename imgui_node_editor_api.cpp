@@ -143,11 +143,21 @@ void ax::NodeEditor::End()
     s_Editor->End();
 }
 
+bool ax::NodeEditor::CanReuseFrame()
+{
+    return s_Editor->CanReuseFrame();
+}
+
 void ax::NodeEditor::BeginNode(NodeId id)
 {
     s_Editor->GetNodeBuilder().Begin(id);
 }
 
+bool ax::NodeEditor::BeginNode(NodeId id, int contentVersion)
+{
+    return s_Editor->GetNodeBuilder().Begin(id, contentVersion);
+}
+
 void ax::NodeEditor::BeginPin(PinId id, PinKind kind)
 {
     s_Editor->GetNodeBuilder().BeginPin(id, kind);
@@ -566,6 +576,22 @@ int ax::NodeEditor::BreakLinks(PinId pinId)
     return s_Editor->BreakLinks(pinId);
 }
 
+int ax::NodeEditor::GetNodeLinks(NodeId nodeId, LinkId* links, int size)
+{
+    std::vector<ax::NodeEditor::Detail::Link*> result;
+    s_Editor->FindLinksForNode(nodeId, result);
+
+    return BuildIdList(result, links, size, [](auto) { return true; });
+}
+
+int ax::NodeEditor::GetPinLinks(PinId pinId, LinkId* links, int size)
+{
+    std::vector<ax::NodeEditor::Detail::Link*> result;
+    s_Editor->FindLinksForPin(pinId, result);
+
+    return BuildIdList(result, links, size, [](auto) { return true; });
+}
+
 void ax::NodeEditor::NavigateToContent(float duration)
 {
     s_Editor->NavigateTo(s_Editor->GetContentBounds(), true, duration);
@@ -667,6 +693,11 @@ float ax::NodeEditor::GetCurrentZoom()
     return s_Editor->GetView().InvScale;
 }
 
+ax::NodeEditor::LevelOfDetail ax::NodeEditor::GetLevelOfDetail()
+{
+    return s_Editor->GetLevelOfDetail();
+}
+
 ax::NodeEditor::NodeId ax::NodeEditor::GetHoveredNode()
 {
     return s_Editor->GetHoveredNode();
@@ -731,6 +762,31 @@ bool ax::NodeEditor::GetLinkPins(LinkId linkId, PinId* startPinId, PinId* endPin
     return true;
 }
 
+float ax::NodeEditor::GetLinkLength(LinkId linkId)
+{
+    auto link = s_Editor->FindLink(linkId);
+    if (!link)
+        return 0.0f;
+
+    return link->GetArcLengthTable().GetLength();
+}
+
+bool ax::NodeEditor::SampleLink(LinkId linkId, float distance, ImVec2* point, ImVec2* tangent)
+{
+    auto link = s_Editor->FindLink(linkId);
+    if (!link)
+        return false;
+
+    const auto& path = link->GetArcLengthTable();
+
+    if (point)
+        *point = path.SamplePoint(distance);
+    if (tangent)
+        *tangent = path.SampleTangent(distance);
+
+    return true;
+}
+
 bool ax::NodeEditor::PinHadAnyLinks(PinId pinId)
 {
     return s_Editor->PinHadAnyLinks(pinId);
@@ -32,6 +32,9 @@
 
 # include <vector>
 # include <string>
+# include <new>
+# include <algorithm>
+# include <unordered_map>
 
 
 //------------------------------------------------------------------------------
@@ -144,6 +147,7 @@ using ax::NodeEditor::PinKind;
 using ax::NodeEditor::StyleColor;
 using ax::NodeEditor::StyleVar;
 using ax::NodeEditor::SaveReasonFlags;
+using ax::NodeEditor::LevelOfDetail;
 
 using ax::NodeEditor::NodeId;
 using ax::NodeEditor::PinId;
@@ -179,10 +183,13 @@ private:
 
 struct EditorContext;
 
+struct Object;
 struct Node;
 struct Pin;
 struct Link;
 
+struct FlowAnimation;
+
 template <typename T, typename Id = typename T::IdType>
 struct ObjectWrapper
 {
@@ -201,6 +208,738 @@ struct ObjectWrapper
     }
 };
 
+// Open addressing hash table (linear probing) mapping object id to object.
+// Slot is empty when it does not hold an object, so every id value is a valid key.
+template <typename T, typename Id = typename T::IdType>
+struct ObjectIndex
+{
+    using Slot = ObjectWrapper<T, Id>;
+
+    ObjectIndex(): m_Count(0) {}
+
+    T* Find(Id id) const
+    {
+        if (m_Slots.empty())
+            return nullptr;
+
+        const auto mask = m_Slots.size() - 1;
+        for (auto i = Hash(id) & mask; m_Slots[i].m_Object; i = (i + 1) & mask)
+            if (m_Slots[i].m_ID == id)
+                return m_Slots[i].m_Object;
+
+        return nullptr;
+    }
+
+    void Insert(Id id, T* object)
+    {
+        IM_ASSERT(object != nullptr);
+        IM_ASSERT(Find(id) == nullptr);
+
+        // Keep load factor below 3/4, probe sequences stay short
+        if ((m_Count + 1) * 4 > m_Slots.size() * 3)
+            Rehash(ImMax<size_t>(16, m_Slots.size() * 2));
+
+        Place(id, object);
+        ++m_Count;
+    }
+
+    bool Remove(Id id)
+    {
+        if (m_Slots.empty())
+            return false;
+
+        const auto mask = m_Slots.size() - 1;
+
+        auto i = Hash(id) & mask;
+        while (m_Slots[i].m_Object && m_Slots[i].m_ID != id)
+            i = (i + 1) & mask;
+
+        if (!m_Slots[i].m_Object)
+            return false;
+
+        // Backward shift deletion, no tombstones are left behind
+        for (auto j = (i + 1) & mask; m_Slots[j].m_Object; j = (j + 1) & mask)
+        {
+            const auto home = Hash(m_Slots[j].m_ID) & mask;
+
+            const auto canMove = (i <= j) ? (home <= i || home > j) : (home <= i && home > j);
+            if (canMove)
+            {
+                m_Slots[i] = m_Slots[j];
+                i = j;
+            }
+        }
+
+        m_Slots[i] = Slot{ Id(), nullptr };
+        --m_Count;
+
+        return true;
+    }
+
+    void Clear()
+    {
+        vector<Slot>().swap(m_Slots);
+        m_Count = 0;
+    }
+
+    size_t Size() const { return m_Count; }
+
+private:
+    static size_t Hash(Id id)
+    {
+        // Ids are often small sequential integers, scramble all bits (MurmurHash3 finalizer)
+        auto key = static_cast<uint64_t>(id.Get());
+        key ^= key >> 33;
+        key *= 0xFF51AFD7ED558CCDull;
+        key ^= key >> 33;
+        return static_cast<size_t>(key);
+    }
+
+    void Place(Id id, T* object)
+    {
+        const auto mask = m_Slots.size() - 1;
+
+        auto i = Hash(id) & mask;
+        while (m_Slots[i].m_Object)
+            i = (i + 1) & mask;
+
+        m_Slots[i] = Slot{ id, object };
+    }
+
+    void Rehash(size_t capacity)
+    {
+        vector<Slot> slots(capacity, Slot{ Id(), nullptr });
+        slots.swap(m_Slots);
+
+        for (auto& slot : slots)
+            if (slot.m_Object)
+                Place(slot.m_ID, slot.m_Object);
+    }
+
+    vector<Slot> m_Slots;
+    size_t       m_Count;
+};
+
+// Fixed size block allocator for editor objects. Objects of the same type live
+// in contiguous chunks, destroyed ones return to intrusive free list for reuse.
+template <typename T, int ChunkSize = 256>
+struct ObjectPool
+{
+    struct Stats
+    {
+        int Live;           // objects currently allocated
+        int HighWaterMark;  // maximum number of objects allocated at once
+        int Capacity;       // number of slots in all chunks
+    };
+
+    ObjectPool(): m_FreeList(nullptr), m_Live(0), m_HighWaterMark(0) {}
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    ~ObjectPool()
+    {
+        IM_ASSERT(m_Live == 0 && "All objects must be destroyed before pool is released.");
+
+        for (auto chunk : m_Chunks)
+            delete chunk;
+    }
+
+    template <typename... Args>
+    T* Create(Args&&... args)
+    {
+        if (!m_FreeList)
+            Grow();
+
+        auto slot  = m_FreeList;
+        m_FreeList = slot->Next;
+
+        ++m_Live;
+        m_HighWaterMark = ImMax(m_HighWaterMark, m_Live);
+
+        return new (slot->Storage) T(std::forward<Args>(args)...);
+    }
+
+    void Destroy(T* object)
+    {
+        if (!object)
+            return;
+
+        object->~T();
+
+        auto slot  = reinterpret_cast<Slot*>(object);
+        slot->Next = m_FreeList;
+        m_FreeList = slot;
+
+        --m_Live;
+    }
+
+    Stats GetStats() const
+    {
+        return Stats{ m_Live, m_HighWaterMark, static_cast<int>(m_Chunks.size()) * ChunkSize };
+    }
+
+private:
+    union Slot
+    {
+        Slot* Next;
+        alignas(T) unsigned char Storage[sizeof(T)];
+    };
+
+    struct Chunk
+    {
+        Slot Slots[ChunkSize];
+    };
+
+    void Grow()
+    {
+        auto chunk = new Chunk;
+        m_Chunks.push_back(chunk);
+
+        // Thread slots in reverse, so they are handed out in address order
+        for (int i = ChunkSize - 1; i >= 0; --i)
+        {
+            chunk->Slots[i].Next = m_FreeList;
+            m_FreeList = &chunk->Slots[i];
+        }
+    }
+
+    vector<Chunk*> m_Chunks;
+    Slot*          m_FreeList;
+    int            m_Live;
+    int            m_HighWaterMark;
+};
+
+// Cells occupied by object registered in SpatialGrid.
+struct SpatialGridEntry
+{
+    int  m_MinX, m_MinY, m_MaxX, m_MaxY;
+    bool m_IsRegistered;
+    bool m_IsCoarse;
+    bool m_IsOversized;
+
+    SpatialGridEntry()
+        : m_MinX(0), m_MinY(0), m_MaxX(-1), m_MaxY(-1)
+        , m_IsRegistered(false)
+        , m_IsCoarse(false)
+        , m_IsOversized(false)
+    {
+    }
+};
+
+// Uniform hashed grid over canvas space. Object is registered in every cell
+// touched by its bounds. Objects spanning too many cells, usually groups, go
+// to coarse level with much larger cells. Objects spanning too many coarse
+// cells are kept on separate list, which is checked by every query. Updates
+// touch only cells object enters or leaves, queries visit only cells
+// overlapping query rectangle.
+//
+// T has to provide 'SpatialGridEntry m_GridEntry' member.
+template <typename T>
+struct SpatialGrid
+{
+    static const int c_MaxCellsPerObject = 64;
+    static const int c_CoarseCellFactor  = 16;
+
+    SpatialGrid(float cellSize = 256.0f)
+        : m_InvCellSize(1.0f / cellSize)
+        , m_InvCoarseCellSize(1.0f / (cellSize * c_CoarseCellFactor))
+    {
+    }
+
+    // Register object or move it to cells covered by new bounds.
+    void Update(T* object, const ImRect& bounds)
+    {
+        auto& entry = object->m_GridEntry;
+
+        int minX, minY, maxX, maxY;
+        GetCellRange(bounds, m_InvCellSize, minX, minY, maxX, maxY);
+
+        const auto isCoarse = GetCellCount(minX, minY, maxX, maxY) > c_MaxCellsPerObject;
+        if (isCoarse)
+            GetCellRange(bounds, m_InvCoarseCellSize, minX, minY, maxX, maxY);
+
+        if (entry.m_IsRegistered && entry.m_IsCoarse == isCoarse && entry.m_MinX == minX && entry.m_MinY == minY && entry.m_MaxX == maxX && entry.m_MaxY == maxY)
+            return;
+
+        Remove(object);
+
+        entry.m_MinX         = minX;
+        entry.m_MinY         = minY;
+        entry.m_MaxX         = maxX;
+        entry.m_MaxY         = maxY;
+        entry.m_IsRegistered = true;
+        entry.m_IsCoarse     = isCoarse;
+        entry.m_IsOversized  = isCoarse && GetCellCount(minX, minY, maxX, maxY) > c_MaxCellsPerObject;
+
+        if (entry.m_IsOversized)
+        {
+            m_Oversized.push_back(object);
+            return;
+        }
+
+        auto& cells = isCoarse ? m_CoarseCells : m_Cells;
+        for (int y = minY; y <= maxY; ++y)
+            for (int x = minX; x <= maxX; ++x)
+                cells[Key(x, y)].push_back(object);
+    }
+
+    void Remove(T* object)
+    {
+        auto& entry = object->m_GridEntry;
+        if (!entry.m_IsRegistered)
+            return;
+
+        entry.m_IsRegistered = false;
+
+        if (entry.m_IsOversized)
+        {
+            Erase(m_Oversized, object);
+            return;
+        }
+
+        auto& cells = entry.m_IsCoarse ? m_CoarseCells : m_Cells;
+        for (int y = entry.m_MinY; y <= entry.m_MaxY; ++y)
+        {
+            for (int x = entry.m_MinX; x <= entry.m_MaxX; ++x)
+            {
+                auto cell = cells.find(Key(x, y));
+                IM_ASSERT(cell != cells.end());
+
+                Erase(cell->second, object);
+                if (cell->second.empty())
+                    cells.erase(cell);
+            }
+        }
+    }
+
+    void Clear()
+    {
+        m_Cells.clear();
+        m_CoarseCells.clear();
+        m_Oversized.resize(0);
+    }
+
+    // Append objects which may overlap rectangle. Object spanning several
+    // cells is reported once per cell, callers are expected to test and
+    // deduplicate candidates.
+    void Query(const ImRect& rect, vector<T*>& result) const
+    {
+        result.insert(result.end(), m_Oversized.begin(), m_Oversized.end());
+
+        QueryCells(m_Cells, m_InvCellSize, rect, result);
+
+        if (!m_CoarseCells.empty())
+            QueryCells(m_CoarseCells, m_InvCoarseCellSize, rect, result);
+    }
+
+    void Query(const ImVec2& point, vector<T*>& result) const
+    {
+        Query(ImRect(point, point), result);
+    }
+
+private:
+    using CellMap = std::unordered_map<unsigned long long, vector<T*>>;
+
+    static unsigned long long Key(int x, int y)
+    {
+        return static_cast<unsigned long long>(static_cast<unsigned int>(x))
+            | (static_cast<unsigned long long>(static_cast<unsigned int>(y)) << 32);
+    }
+
+    static int ToCell(float v, float invCellSize)
+    {
+        // Keep cell coordinates in range where cell counts cannot overflow
+        const float limit = static_cast<float>(1 << 28);
+        return static_cast<int>(ImFloor(ImClamp(v * invCellSize, -limit, limit)));
+    }
+
+    static void GetCellRange(const ImRect& bounds, float invCellSize, int& minX, int& minY, int& maxX, int& maxY)
+    {
+        minX = ToCell(ImMin(bounds.Min.x, bounds.Max.x), invCellSize);
+        minY = ToCell(ImMin(bounds.Min.y, bounds.Max.y), invCellSize);
+        maxX = ToCell(ImMax(bounds.Min.x, bounds.Max.x), invCellSize);
+        maxY = ToCell(ImMax(bounds.Min.y, bounds.Max.y), invCellSize);
+    }
+
+    static long long GetCellCount(int minX, int minY, int maxX, int maxY)
+    {
+        return static_cast<long long>(maxX - minX + 1) * (maxY - minY + 1);
+    }
+
+    static void QueryCells(const CellMap& cells, float invCellSize, const ImRect& rect, vector<T*>& result)
+    {
+        int minX, minY, maxX, maxY;
+        GetCellRange(rect, invCellSize, minX, minY, maxX, maxY);
+
+        if (GetCellCount(minX, minY, maxX, maxY) > static_cast<long long>(cells.size()))
+        {
+            // Rectangle covers more cells than there are occupied, visit occupied ones instead
+            for (auto& cell : cells)
+            {
+                const auto x = static_cast<int>(static_cast<unsigned int>(cell.first));
+                const auto y = static_cast<int>(static_cast<unsigned int>(cell.first >> 32));
+                if (x >= minX && x <= maxX && y >= minY && y <= maxY)
+                    result.insert(result.end(), cell.second.begin(), cell.second.end());
+            }
+        }
+        else
+        {
+            for (int y = minY; y <= maxY; ++y)
+            {
+                for (int x = minX; x <= maxX; ++x)
+                {
+                    auto cell = cells.find(Key(x, y));
+                    if (cell != cells.end())
+                        result.insert(result.end(), cell->second.begin(), cell->second.end());
+                }
+            }
+        }
+    }
+
+    static void Erase(vector<T*>& objects, T* object)
+    {
+        auto it = std::find(objects.begin(), objects.end(), object);
+        IM_ASSERT(it != objects.end());
+        *it = objects.back();
+        objects.pop_back();
+    }
+
+    float      m_InvCellSize;
+    float      m_InvCoarseCellSize;
+    CellMap    m_Cells;
+    CellMap    m_CoarseCells;
+    vector<T*> m_Oversized;
+};
+
+// Copy of geometry some code emitted to draw list. Captured vertices keep
+// their positions, indices are stored relative to first captured vertex,
+// so geometry can be appended again at any place in any draw list.
+struct DrawGeometryCache
+{
+    void Store(const ImDrawVert* vertices, int vertexCount, const ImDrawIdx* indices, int indexCount, unsigned int firstVertexIndex);
+    void Write(ImDrawVert* vertices, ImDrawIdx* indices, unsigned int firstVertexIndex) const;
+    void Clear();
+
+    bool IsValid() const { return m_IsValid; }
+
+    int GetVertexCount() const { return m_Vertices.Size; }
+    int GetIndexCount() const { return m_Indices.Size; }
+
+private:
+    ImVector<ImDrawVert> m_Vertices;
+    ImVector<ImDrawIdx>  m_Indices;
+    bool                 m_IsValid = false;
+};
+
+// Arc length parameterization of a curve. Curve is measured with small
+// uniform time steps and table is resampled so entries are evenly spaced
+// by distance. Finding time at given distance is a lookup and a lerp,
+// points and tangents are evaluated on the curve itself.
+struct ArcLengthTable
+{
+    void Build(const ImCubicBezierPoints& curve);
+    void Clear();
+
+    bool  IsValid() const { return m_IsValid; }
+    float GetLength() const { return m_Length; }
+
+    float  GetTime(float distance) const;
+    ImVec2 SamplePoint(float distance) const;
+    ImVec2 SampleTangent(float distance) const; // unit length
+
+private:
+    ImCubicBezierPoints m_Curve;
+    float               m_Length = 0.0f;
+    ImVector<float>     m_Times; // time at distance i * m_Length / (m_Times.Size - 1)
+    bool                m_IsValid = false;
+};
+
+// Rounded rectangles are tessellated once for each look and stamped at any
+// position, size and color after that. Rectangle is made of corner arcs joined
+// by straight edges, so template vertices are kept relative to the corner they
+// belong to. Geometry is the one ImDrawList::AddRect() and AddRectFilled()
+// produce, template is captured from first of them.
+struct ShapeCache
+{
+    void AddRectFilled(ImDrawList* drawList, const ImVec2& a, const ImVec2& b, ImU32 color, float rounding, int corners);
+    void AddRect(ImDrawList* drawList, const ImVec2& a, const ImVec2& b, ImU32 color, float rounding, int corners, float thickness);
+
+    void Clear();
+
+    int GetTemplateCount() const { return static_cast<int>(m_Templates.size()); }
+
+private:
+    // Everything template geometry depends on, but position, size and color.
+    struct Key
+    {
+        float           Rounding;
+        int             Corners;
+        float           Thickness; // zero for filled rectangle
+        float           FringeScale;
+        ImDrawListFlags DrawListFlags;
+        ImVec2          TexUvWhitePixel;
+
+        bool operator==(const Key& rhs) const
+        {
+            return Rounding == rhs.Rounding
+                && Corners == rhs.Corners
+                && Thickness == rhs.Thickness
+                && FringeScale == rhs.FringeScale
+                && DrawListFlags == rhs.DrawListFlags
+                && TexUvWhitePixel == rhs.TexUvWhitePixel;
+        }
+    };
+
+    struct Template
+    {
+        Key                  m_Key;
+        ImVector<ImDrawVert> m_Vertices; // relative to the corner, color holds only alpha
+        ImVector<ImU8>       m_Corners;  // bit 0 - right corner, bit 1 - bottom corner
+        ImVector<ImDrawIdx>  m_Indices;
+    };
+
+    void Draw(ImDrawList* drawList, const ImVec2& a, const ImVec2& b, ImU32 color, const Key& key);
+
+    vector<Template> m_Templates;
+};
+
+// Draw commands submitted as node content. Recorded in canvas space and
+// replayed translated to where node is now, as long as user reports same
+// content version.
+struct NodeContentCache
+{
+    // Position in draw list where recording begins.
+    struct Mark
+    {
+        int          m_VtxStart;
+        int          m_IdxStart;
+        unsigned int m_VtxIndexStart;
+        unsigned int m_VtxOffset;
+        ImVec4       m_ClipRect;
+    };
+
+    static Mark Begin(ImDrawList* drawList);
+
+    // Records everything drawn since mark. Returns false if content cannot
+    // be replayed, like when it contains draw callbacks.
+    bool Store(ImDrawList* drawList, const Mark& mark, const ImVec2& origin);
+
+    // Commands clipped to the rectangle which was current while recording
+    // are clipped to current one instead.
+    void Replay(ImDrawList* drawList, const ImVec2& origin) const;
+
+    void Clear();
+
+    // Content is valid only for the same font and fringe, geometry
+    // produced by ImGui depends on them.
+    bool IsValid(ImDrawList* drawList) const;
+
+private:
+    struct Command
+    {
+        ImVec4      m_ClipRect;
+        ImTextureID m_TextureId;
+        int         m_IdxStart;
+        int         m_IdxCount;
+    };
+
+    ImVector<ImDrawVert> m_Vertices;
+    ImVector<ImDrawIdx>  m_Indices;
+    ImVector<Command>    m_Commands;
+    ImVec2               m_Origin;
+    ImVec4               m_ClipRect;
+    ImFont*              m_Font        = nullptr;
+    float                m_FontSize    = 0.0f;
+    float                m_FringeScale = 0.0f;
+    ImDrawListFlags      m_Flags       = 0;
+    ImVec2               m_TexUvWhitePixel;
+    bool                 m_IsValid     = false;
+};
+
+// Links are not stroked one by one through ImDrawList path API. Draw requests
+// are queued and emitted in batches, all links of a channel go into memory
+// reserved once. Curves are tessellated with tolerance scaled by the view,
+// so zoomed out links use fewer points. Stroke geometry is the same
+// ImDrawList::AddPolyline() and AddConvexPolyFilled() would produce.
+struct LinkBatcher
+{
+    // Sets tessellation tolerance in canvas units. When links tessellated in
+    // frame would need more than 'pointBudget' points, they are tessellated
+    // with coarser tolerance. Zero budget means no limit.
+    void Begin(float tessellationTolerance, int pointBudget = 0);
+
+    // Queues link to be drawn into channel. Geometry is replayed from cache
+    // when it is valid, otherwise cache is filled when batch is emitted.
+    void Add(int channel, const Link* link, ImU32 color, float extraThickness, DrawGeometryCache* cache = nullptr);
+
+    // Emits all queued links. Current channel of the draw list is preserved.
+    void Flush(ImDrawList* drawList);
+
+    // Number of points links were tessellated into in previous frame.
+    int GetLastPointCount() const { return m_LastPointCount; }
+
+private:
+    struct Item
+    {
+        ImCubicBezierPoints m_Curve;
+        float               m_Thickness;
+        float               m_StartArrowSize;
+        float               m_StartArrowWidth;
+        float               m_EndArrowSize;
+        float               m_EndArrowWidth;
+        ImVec2              m_StartDir;
+        ImVec2              m_EndDir;
+        bool                m_IsStraight;
+        ImU32               m_Color;
+        int                 m_Channel;
+        DrawGeometryCache*  m_Cache;
+        bool                m_Replay;
+        int                 m_PointStart;
+        int                 m_PointCount;
+        int                 m_VtxCount;
+        int                 m_IdxCount;
+    };
+
+    void Prepare(ImDrawList* drawList, Item& item, float tessellationTolerance);
+    void Emit(ImDrawList* drawList, const Item& item, ImDrawVert* vtx, ImDrawIdx* idx, unsigned int vtxIndex);
+
+    float          m_TessellationTolerance = 0.0f;
+    int            m_PointBudget           = 0;
+    int            m_PointCount            = 0;
+    int            m_LastPointCount        = 0;
+    vector<Item>   m_Items;
+    vector<ImVec2> m_Points;
+    vector<ImVec2> m_Normals;
+};
+
+// Background grid is drawn in levels, each level is a few times coarser than
+// previous one. Level is picked from zoom so number of lines stay bounded
+// regardless of how far view is zoomed out. Lines of finer level fade out
+// while they get dense, coarser ones take over. Geometry is kept and
+// replayed as long as view does not change.
+struct BackgroundGrid
+{
+    void Draw(ImDrawList* drawList, const ImRect& viewRect, float viewScale, ImU32 color);
+
+private:
+    // Everything grid geometry depends on.
+    struct Key
+    {
+        ImRect          ViewRect;
+        float           ViewScale;
+        ImU32           Color;
+        float           FringeScale;
+        ImDrawListFlags DrawListFlags;
+        ImVec2          TexUvWhitePixel;
+        ImTextureID     TextureId;
+
+        bool operator==(const Key& rhs) const
+        {
+            return ViewRect.Min == rhs.ViewRect.Min && ViewRect.Max == rhs.ViewRect.Max
+                && ViewScale == rhs.ViewScale
+                && Color == rhs.Color
+                && FringeScale == rhs.FringeScale
+                && DrawListFlags == rhs.DrawListFlags
+                && TexUvWhitePixel == rhs.TexUvWhitePixel && TextureId == rhs.TextureId;
+        }
+    };
+
+    Key               m_Key;
+    DrawGeometryCache m_Cache;
+};
+
+// Geometry editor drew in canvas space during last frame. While nothing but
+// the view changes, frame is replayed from it instead of being rebuilt from
+// what user submitted.
+struct FrameCache
+{
+    // Everything captured geometry depends on.
+    struct Key
+    {
+        ImRect            ClipRect;
+        float             ViewScale;
+        LevelOfDetail     Detail;
+        Object*           HotObject;
+        ImFont*           Font;
+        float             FontSize;
+        ImDrawListFlags   DrawListFlags;
+        ImVec2            TexUvWhitePixel;
+        NodeEditor::Style EditorStyle;
+        bool              HasMargin;
+    };
+
+    // Records commands of channels in [firstChannel, lastChannel), all their
+    // vertices must be emitted past vtxStart. Returns false if frame cannot
+    // be replayed, like when it contains draw callbacks.
+    bool Store(ImDrawList* drawList, int firstChannel, int lastChannel, int vtxStart, const Key& key);
+
+    // Commands go back to channels they were recorded from. Ones clipped to
+    // the rectangle of the key are clipped to current one instead, others
+    // are clipped to both.
+    void Replay(ImDrawList* drawList) const;
+
+    void Clear();
+
+    bool IsValid() const { return m_IsValid; }
+    const Key& GetKey() const { return m_Key; }
+
+private:
+    struct Command
+    {
+        int         m_Channel;
+        ImVec4      m_ClipRect;
+        ImTextureID m_TextureId;
+        int         m_VtxStart;
+        int         m_VtxCount;
+        int         m_IdxStart;
+        int         m_IdxCount;
+    };
+
+    ImVector<ImDrawVert> m_Vertices;
+    ImVector<ImDrawIdx>  m_Indices;
+    ImVector<Command>    m_Commands;
+    Key                  m_Key;
+    bool                 m_IsValid = false;
+};
+
+// All nodes draw into one channel. Each range of that channel is tagged with
+// node and layer it belongs to, at the end of the frame ranges are reordered
+// by node order and layer.
+struct NodeLayerSorter
+{
+    void Begin(int channel);
+    void SetCurrent(ImDrawList* drawList, Node* node, int layer);
+
+    // Node builder checks nothing was drawn to other layer while it recorded content
+    int GetSegmentCount() const { return static_cast<int>(m_Segments.size()); }
+    bool IsCurrent(const Node* node, int layer) const { return !m_Segments.empty() && m_Segments.back().m_Node == node && m_Segments.back().m_Layer == layer; }
+    void End(ImDrawList* drawList, int groupChannel, int groupCount, unsigned int layerMask);
+
+private:
+    struct Segment
+    {
+        Node* m_Node;
+        int   m_Layer;
+        int   m_IdxStart;
+        int   m_PieceStart;
+        int   m_PieceEnd;
+    };
+
+    // Part of draw command which belongs to single segment
+    struct Piece
+    {
+        int m_CommandIndex;
+        int m_IdxStart;
+        int m_IdxCount;
+    };
+
+    int             m_Channel = 0;
+    vector<Segment> m_Segments;
+    vector<Piece>   m_Pieces;
+    vector<int>     m_Order;
+    ImDrawChannel   m_Sorted;
+};
+
 struct Object
 {
     enum DrawFlags
@@ -308,6 +1047,9 @@ struct Pin final: Object
     bool    m_SnapLinkToDir;
     bool    m_HasConnection;
     bool    m_HadConnection;
+    Link*   m_FirstLink;
+
+    SpatialGridEntry m_GridEntry;
 
     Pin(EditorContext* editor, PinId id, PinKind kind)
         : Object(editor)
@@ -329,9 +1071,13 @@ struct Pin final: Object
         , m_SnapLinkToDir(true)
         , m_HasConnection(false)
         , m_HadConnection(false)
+        , m_FirstLink(nullptr)
+        , m_GridEntry()
     {
     }
 
+    virtual ~Pin() override;
+
     virtual ObjectId ID() override { return m_ID; }
 
     virtual void Reset() override final
@@ -385,7 +1131,6 @@ struct Node final: Object
     NodeType m_Type;
     ImRect   m_Bounds;
     float    m_ZPosition;
-    int      m_Channel;
     Pin*     m_LastPin;
     ImVec2   m_DragStart;
 
@@ -405,13 +1150,20 @@ struct Node final: Object
     bool     m_RestoreState;
     bool     m_CenterOnScreen;
 
+    int              m_ContentVersion; // reported by user to BeginNode()
+    ImVec2           m_ContentOrigin;  // where content was placed last time
+    ImVec2           m_ContentSize;
+    NodeContentCache m_ContentCache;
+
+    int              m_Order;     // position in EditorContext::m_Nodes
+    SpatialGridEntry m_GridEntry;
+
     Node(EditorContext* editor, NodeId id)
         : Object(editor)
         , m_ID(id)
         , m_Type(NodeType::Node)
         , m_Bounds()
         , m_ZPosition(0.0f)
-        , m_Channel(0)
         , m_LastPin(nullptr)
         , m_DragStart()
         , m_Color(IM_COL32_WHITE)
@@ -422,9 +1174,17 @@ struct Node final: Object
         , m_HighlightConnectedLinks(false)
         , m_RestoreState(false)
         , m_CenterOnScreen(false)
+        , m_ContentVersion(0)
+        , m_ContentOrigin()
+        , m_ContentSize()
+        , m_ContentCache()
+        , m_Order(0)
+        , m_GridEntry()
     {
     }
 
+    virtual ~Node() override;
+
     virtual ObjectId ID() override { return m_ID; }
 
     bool AcceptDrag() override;
@@ -462,6 +1222,16 @@ struct Link final: Object
     ImVec2 m_Start;
     ImVec2 m_End;
 
+    // Links attached to the same pin form intrusive list starting
+    // at Pin::m_FirstLink, every link has separate entry for each end.
+    Pin*   m_AttachedPin[2];
+    Link*  m_PrevAttached[2];
+    Link*  m_NextAttached[2];
+
+    int              m_Order;     // creation order, links in EditorContext::m_Links are sorted by it
+    SpatialGridEntry m_GridEntry;
+    FlowAnimation*   m_FlowAnimation; // last flow played on this link, owned by FlowAnimationController
+
     Link(EditorContext* editor, LinkId id)
         : Object(editor)
         , m_ID(id)
@@ -469,19 +1239,36 @@ struct Link final: Object
         , m_EndPin(nullptr)
         , m_Color(IM_COL32_WHITE)
         , m_Thickness(1.0f)
+        , m_AttachedPin{ nullptr, nullptr }
+        , m_PrevAttached{ nullptr, nullptr }
+        , m_NextAttached{ nullptr, nullptr }
+        , m_Order(0)
+        , m_GridEntry()
+        , m_FlowAnimation(nullptr)
+        , m_IsCurveValid(false)
     {
     }
 
+    virtual ~Link() override;
+
     virtual ObjectId ID() override { return m_ID; }
 
+    void AttachToPins(Pin* startPin, Pin* endPin);
+    void DetachFromPins();
+    void DetachFromPin(Pin* pin);
+
+    Link* GetNextAttached(const Pin* pin) const { return m_NextAttached[GetAttachedEnd(pin)]; }
+
     virtual bool IsSelectable() override { return true; }
 
     virtual void Draw(ImDrawList* drawList, DrawFlags flags = None) override final;
     void Draw(ImDrawList* drawList, ImU32 color, float extraThickness = 0.0f) const;
+    void DrawCached(ImDrawList* drawList, ImU32 color) const;
 
     void UpdateEndpoints();
 
     ImCubicBezierPoints GetCurve() const;
+    const ArcLengthTable& GetArcLengthTable() const;
 
     virtual bool TestHit(const ImVec2& point, float extraThickness = 0.0f) const override final;
     virtual bool TestHit(const ImRect& rect, bool allowIntersect = true) const override final;
@@ -489,6 +1276,118 @@ struct Link final: Object
     virtual ImRect GetBounds() const override final;
 
     virtual Link* AsLink() override final { return this; }
+
+private:
+    int  GetAttachedEnd(const Pin* pin) const { return m_AttachedPin[0] == pin ? 0 : 1; }
+    void Attach(int end, Pin* pin);
+    void Detach(int end);
+
+    // Everything curve and bounds depend on. Cached values are rebuilt
+    // only when one of these changes.
+    struct CurveKey
+    {
+        ImVec2 Start;
+        ImVec2 End;
+        ImVec2 StartDir;
+        ImVec2 EndDir;
+        float  StartStrength;
+        float  EndStrength;
+        float  StartArrowSize;
+        float  EndArrowSize;
+
+        bool operator==(const CurveKey& rhs) const
+        {
+            return Start == rhs.Start && End == rhs.End
+                && StartDir == rhs.StartDir && EndDir == rhs.EndDir
+                && StartStrength == rhs.StartStrength && EndStrength == rhs.EndStrength
+                && StartArrowSize == rhs.StartArrowSize && EndArrowSize == rhs.EndArrowSize;
+        }
+    };
+
+    void UpdateCurve() const;
+
+    mutable bool                m_IsCurveValid;
+    mutable CurveKey            m_CurveKey;
+    mutable ImCubicBezierPoints m_Curve;
+    mutable ImRect              m_CurveBounds;
+    mutable ArcLengthTable      m_ArcLength; // built on first use
+
+    // Everything tessellated geometry depends on.
+    struct DrawKey
+    {
+        ImCubicBezierPoints Curve;
+        float               Thickness;
+        float               StartArrowSize;
+        float               StartArrowWidth;
+        float               EndArrowSize;
+        float               EndArrowWidth;
+        ImVec2              StartDir;
+        ImVec2              EndDir;
+        bool                SnapStartToDir;
+        bool                SnapEndToDir;
+        ImU32               Color;
+        float               FringeScale;
+        float               CurveTessellationTol;
+        ImDrawListFlags     DrawListFlags;
+        ImVec2              TexUvWhitePixel;
+        ImTextureID         TextureId;
+
+        bool operator==(const DrawKey& rhs) const
+        {
+            return Curve.P0 == rhs.Curve.P0 && Curve.P1 == rhs.Curve.P1 && Curve.P2 == rhs.Curve.P2 && Curve.P3 == rhs.Curve.P3
+                && Thickness == rhs.Thickness
+                && StartArrowSize == rhs.StartArrowSize && StartArrowWidth == rhs.StartArrowWidth
+                && EndArrowSize == rhs.EndArrowSize && EndArrowWidth == rhs.EndArrowWidth
+                && StartDir == rhs.StartDir && EndDir == rhs.EndDir
+                && SnapStartToDir == rhs.SnapStartToDir && SnapEndToDir == rhs.SnapEndToDir
+                && Color == rhs.Color
+                && FringeScale == rhs.FringeScale && CurveTessellationTol == rhs.CurveTessellationTol
+                && DrawListFlags == rhs.DrawListFlags
+                && TexUvWhitePixel == rhs.TexUvWhitePixel && TextureId == rhs.TextureId;
+        }
+    };
+
+    mutable DrawKey           m_DrawKey;
+    mutable DrawGeometryCache m_DrawCache;
+};
+
+// Structure of arrays mirror of object bounds rebuilt once per frame.
+// Visibility of all objects is resolved in single pass over contiguous
+// data, draw loops consume list of visible indices instead of testing
+// objects one by one.
+struct VisibilityCuller
+{
+    template <typename T>
+    void Cull(const vector<ObjectWrapper<T>>& objects, const ImRect& clipRect)
+    {
+        Clear();
+        Reserve(static_cast<int>(objects.size()));
+
+        // Dead objects get inverted bounds which never overlap clip rectangle
+        for (auto& object : objects)
+            Add(object.m_Object->m_IsLive ? object.m_Object->GetBounds() : ImRect(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX));
+
+        CullBounds(clipRect);
+    }
+
+    const vector<int>& GetVisible() const { return m_Visible; }
+
+    ImRect GetBounds(int index) const
+    {
+        return ImRect(m_MinX[index], m_MinY[index], m_MaxX[index], m_MaxY[index]);
+    }
+
+private:
+    void Clear();
+    void Reserve(int count);
+    void Add(const ImRect& bounds);
+    void CullBounds(const ImRect& clipRect);
+
+    vector<float> m_MinX;
+    vector<float> m_MinY;
+    vector<float> m_MaxX;
+    vector<float> m_MaxY;
+    vector<int>   m_Visible;
 };
 
 struct NodeSettings
@@ -526,14 +1425,14 @@ struct NodeSettings
 
 struct Settings
 {
-    bool                 m_IsDirty;
-    SaveReasonFlags      m_DirtyReason;
+    bool                   m_IsDirty;
+    SaveReasonFlags        m_DirtyReason;
 
-    vector<NodeSettings> m_Nodes;
-    vector<ObjectId>     m_Selection;
-    ImVec2               m_ViewScroll;
-    float                m_ViewZoom;
-    ImRect               m_VisibleRect;
+    vector<NodeSettings*>  m_Nodes;
+    vector<ObjectId>       m_Selection;
+    ImVec2                 m_ViewScroll;
+    float                  m_ViewZoom;
+    ImRect                 m_VisibleRect;
 
     Settings()
         : m_IsDirty(false)
@@ -544,6 +1443,11 @@ struct Settings
     {
     }
 
+    Settings(const Settings&) = delete;
+    Settings& operator=(const Settings&) = delete;
+
+    ~Settings();
+
     NodeSettings* AddNode(NodeId id);
     NodeSettings* FindNode(NodeId id);
     void RemoveNode(NodeId id);
@@ -554,6 +1458,11 @@ struct Settings
     std::string Serialize();
 
     static bool Parse(const std::string& string, Settings& settings);
+
+private:
+    // Node settings never move once created, pointers stay valid until settings are destroyed.
+    ObjectPool<NodeSettings>          m_NodePool;
+    ObjectIndex<NodeSettings, NodeId> m_NodeIndex;
 };
 
 struct Control
@@ -664,6 +1573,7 @@ struct Animation
     State           m_State;
     float           m_Time;
     float           m_Duration;
+    int             m_LiveIndex; // position in EditorContext::m_LiveAnimations, -1 if not playing
 
     Animation(EditorContext* editor);
     virtual ~Animation();
@@ -708,32 +1618,21 @@ struct FlowAnimation final: Animation
     float m_Speed;
     float m_MarkerDistance;
     float m_Offset;
+    int   m_ControllerIndex; // position in FlowAnimationController::m_LiveAnimations, -1 if not playing
+    bool  m_IsPooled;
 
     FlowAnimation(FlowAnimationController* controller);
 
     void Flow(Link* link, float markerDistance, float speed, float duration);
+    void DetachLink();
 
-    void Draw(ImDrawList* drawList);
+    void DrawLink(LinkBatcher& linkBatcher);
+    void DrawMarkers(ImDrawList* drawList);
 
 private:
-    struct CurvePoint
-    {
-        float  Distance;
-        ImVec2 Point;
-    };
-
-    ImVec2 m_LastStart;
-    ImVec2 m_LastEnd;
-    float  m_PathLength;
-    vector<CurvePoint> m_Path;
-
     bool IsLinkValid() const;
-    bool IsPathValid() const;
-    void UpdatePath();
-    void ClearPath();
-
-    ImVec2 SamplePath(float distance) const;
 
+    void OnPlay() override final;
     void OnUpdate(float progress) override final;
     void OnStop() override final;
 };
@@ -766,13 +1665,23 @@ struct FlowAnimationController final : AnimationController
 
     virtual void Draw(ImDrawList* drawList) override final;
 
+    void Activate(FlowAnimation* animation);
     void Release(FlowAnimation* animation);
 
+    void DrawMarkers(ImDrawList* drawList, const ImVec2* points, int count, float radius, int segmentCount, ImU32 color);
+
+    vector<ImVec2>& GetMarkerBuffer() { return m_MarkerPoints; }
+
 private:
     FlowAnimation* GetOrCreate(Link* link);
 
-    vector<FlowAnimation*> m_Animations;
-    vector<FlowAnimation*> m_FreePool;
+    vector<FlowAnimation*> m_Animations;     // owned, all ever created
+    vector<FlowAnimation*> m_LiveAnimations; // playing, in no particular order
+    vector<FlowAnimation*> m_FreePool;       // stopped, may still be attached to link
+
+    vector<ImVec2>         m_MarkerPoints;
+    ImVector<ImDrawVert>   m_MarkerVertices;
+    ImVector<ImDrawIdx>    m_MarkerIndices;
 };
 
 struct EditorAction
@@ -855,6 +1764,7 @@ struct NavigateAction final: EditorAction
     void StopMoveOverEdge();
     bool IsMovingOverEdge() const { return m_MovingOverEdge; }
     ImVec2 GetMoveScreenOffset() const { return m_MoveScreenOffset; }
+    bool IsAnimating() const { return m_Animation.IsPlaying(); }
 
     void SetWindow(ImVec2 position, ImVec2 size);
     ImVec2 GetWindowScreenPos() const { return m_WindowScreenPos; };
@@ -1141,6 +2051,7 @@ struct DeleteItemsAction final: EditorAction
     virtual DeleteItemsAction* AsDeleteItems() override final { return this; }
 
     bool Add(Object* object);
+    bool HasManuallyDeletedObjects() const { return !m_ManuallyDeletedObjects.empty(); }
 
     bool Begin();
     void End();
@@ -1188,14 +2099,21 @@ struct NodeBuilder
 
     ImRect m_GroupBounds;
     bool   m_IsGroup;
+    float  m_MaxGroupBorderWidth; // of all groups built in current frame
 
     ImDrawListSplitter m_Splitter;
     ImDrawListSplitter m_PinSplitter;
 
+    bool                   m_IsContentReplayed; // cached content is drawn, user does not submit any
+    bool                   m_IsContentRecorded; // user content is stored in node cache at the end
+    NodeContentCache::Mark m_ContentMark;
+    int                    m_ContentSegmentCount;
+
     NodeBuilder(EditorContext* editor);
     ~NodeBuilder();
 
     void Begin(NodeId nodeId);
+    bool Begin(NodeId nodeId, int contentVersion); // return false, when content was replayed from cache
     void End();
 
     void BeginPin(PinId pinId, PinKind kind);
@@ -1211,6 +2129,14 @@ struct NodeBuilder
 
     ImDrawList* GetUserBackgroundDrawList() const;
     ImDrawList* GetUserBackgroundDrawList(Node* node) const;
+
+    // Editor splitter is put aside while node is built, these bring it back temporarily
+    bool BeginEditorSplitter(ImDrawList* drawList);
+    void EndEditorSplitter(ImDrawList* drawList);
+
+private:
+    bool BeginNode(NodeId nodeId, bool isVersioned, int contentVersion);
+    bool CanReplayContent(ImDrawList* drawList) const;
 };
 
 struct HintBuilder
@@ -1318,6 +2244,14 @@ struct EditorContext
     const ImRect& GetViewRect() const { return m_Canvas.ViewRect(); }
     const ImRect& GetRect() const { return m_Canvas.Rect(); }
 
+    LevelOfDetail GetLevelOfDetail() const { return m_LevelOfDetail; }
+
+    void SetNodeLayer(ImDrawList* drawList, Node* node, int layer) { m_NodeLayers.SetCurrent(drawList, node, layer); }
+    const NodeLayerSorter& GetNodeLayers() const { return m_NodeLayers; }
+
+    LinkBatcher& GetLinkBatcher() { return m_LinkBatcher; }
+    ShapeCache& GetShapeCache() { return m_ShapeCache; }
+
     void SetNodePosition(NodeId nodeId, const ImVec2& screenPosition);
     void SetGroupSize(NodeId nodeId, const ImVec2& size);
     ImVec2 GetNodePosition(NodeId nodeId);
@@ -1345,6 +2279,13 @@ struct EditorContext
 
     Node* FindNodeAt(const ImVec2& p);
     void FindNodesInRect(const ImRect& r, vector<Node*>& result, bool append = false, bool includeIntersecting = true);
+    void UpdateNodeGrid(Node* node) { m_NodeGrid.Update(node, node->m_Bounds); }
+    void RemoveNodeFromGrid(Node* node) { m_NodeGrid.Remove(node); }
+    void UpdateLinkGrid(Link* link) { m_LinkGrid.Update(link, link->GetBounds()); }
+    void RemoveLinkFromGrid(Link* link) { m_LinkGrid.Remove(link); }
+    void UpdatePinGrid(Pin* pin) { m_PinGrid.Update(pin, pin->m_Bounds); }
+    void RemovePinFromGrid(Pin* pin) { m_PinGrid.Remove(pin); }
+    void UpdateNodeOrder();
     void FindLinksInRect(const ImRect& r, vector<Link*>& result, bool append = false);
 
     bool HasAnyLinks(NodeId nodeId) const;
@@ -1354,6 +2295,11 @@ struct EditorContext
     int BreakLinks(PinId pinId);
 
     void FindLinksForNode(NodeId nodeId, vector<Link*>& result, bool add = false);
+    void FindLinksForPin(PinId pinId, vector<Link*>& result, bool add = false);
+
+    // Calls visitor for every live link connected to pin or node until it returns false.
+    template <typename F> bool ForEachLink(const Pin* pin, F&& visitor) const;
+    template <typename F> bool ForEachLink(const Node* node, F&& visitor) const;
 
     bool PinHadAnyLinks(PinId pinId);
 
@@ -1366,6 +2312,11 @@ struct EditorContext
     void Resume(SuspendFlags flags = SuspendFlags::None);
     bool IsSuspended();
 
+    // True while editor replays previous frame, user does not need to
+    // submit nodes and links. Submitting anyway cancels the replay.
+    bool CanReuseFrame() const { return m_IsFrameReused; }
+    void CancelFrameReuse();
+
     bool IsFocused();
     bool IsHovered() const;
     bool IsHoveredWithoutOverlapp() const;
@@ -1478,14 +2429,26 @@ private:
     void SaveSettings();
 
     Control BuildControl(bool allowOffscreen);
+    Object* FindInteractiveObjectAt(const ImVec2& p, const ImRect& clipRect, NodeRegion& region);
 
     void ShowMetrics(const Control& control);
 
+    void ResetObjects();
+    void DrawObjects(const Control& control);
+    bool IsFrameReusable();
+    bool IsFrameCaptureLikely() const;
+    bool IsInputIdle() const;
+
     void UpdateAnimations();
 
+    LevelOfDetail CalculateLevelOfDetail(float viewScale) const;
+
     Config              m_Config;
 
     ImGuiID             m_EditorActiveId;
+    ImGuiID             m_LastEditorActiveId;
+    ObjectId            m_ActiveAreaObject; // object owning active ImGui item, when hit testing with single widget
+    NodeRegion          m_ActiveAreaRegion;
     bool                m_IsFirstFrame;
     bool                m_IsFocused;
     bool                m_IsHovered;
@@ -1499,6 +2462,30 @@ private:
     vector<ObjectWrapper<Pin>>  m_Pins;
     vector<ObjectWrapper<Link>> m_Links;
 
+    ObjectIndex<Node>   m_NodeIndex;
+    ObjectIndex<Pin>    m_PinIndex;
+    ObjectIndex<Link>   m_LinkIndex;
+
+    ObjectPool<Node>    m_NodePool;
+    ObjectPool<Pin>     m_PinPool;
+    ObjectPool<Link>    m_LinkPool;
+
+    VisibilityCuller    m_NodeCuller;
+    VisibilityCuller    m_LinkCuller;
+
+    NodeLayerSorter     m_NodeLayers;
+    LinkBatcher         m_LinkBatcher;
+    BackgroundGrid      m_BackgroundGrid;
+    ShapeCache          m_ShapeCache;
+
+    SpatialGrid<Node>   m_NodeGrid;
+    vector<Node*>       m_NodeQuery;
+    SpatialGrid<Link>   m_LinkGrid;
+    vector<Link*>       m_LinkQuery;
+    SpatialGrid<Pin>    m_PinGrid;
+    vector<Pin*>        m_PinQuery;
+    int                 m_NextLinkOrder;
+
     vector<Object*>     m_SelectedObjects;
 
     vector<Object*>     m_LastSelectedObjects;
@@ -1511,6 +2498,18 @@ private:
 
     ImGuiEx::Canvas     m_Canvas;
     bool                m_IsCanvasVisible;
+    FrameCache          m_FrameCache;
+    bool                m_IsFrameReused;
+    bool                m_IsFrameCacheStale;
+    bool                m_HasFrameMargin;
+    bool                m_IsMarginCaptureFailed;
+    bool                m_IsFrameReplayed;
+    int                 m_FrameCount;
+    int                 m_ReusedFrameCount;
+    int                 m_MarginFrameCount;
+    int                 m_FrameVtxStart;
+    int                 m_FrameExternalIdxCount;
+    LevelOfDetail       m_LevelOfDetail;
 
     NodeBuilder         m_NodeBuilder;
     HintBuilder         m_HintBuilder;
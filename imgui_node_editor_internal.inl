@@ -55,6 +55,49 @@ inline ImVec2 ImGui_GetMouseClickPos(ImGuiMouseButton buttonIndex)
 }
 
 
+//------------------------------------------------------------------------------
+template <typename F>
+inline bool EditorContext::ForEachLink(const Pin* pin, F&& visitor) const
+{
+    for (auto link = pin->m_FirstLink; link; link = link->GetNextAttached(pin))
+    {
+        if (!link->m_IsLive)
+            continue;
+
+        if (!visitor(link))
+            return false;
+    }
+
+    return true;
+}
+
+template <typename F>
+inline bool EditorContext::ForEachLink(const Node* node, F&& visitor) const
+{
+    // Pin list of node is rebuilt every frame, links can be live only
+    // if node was submitted in current frame too.
+    if (!node->m_IsLive)
+        return true;
+
+    for (auto pin = node->m_LastPin; pin; pin = pin->m_PreviousPin)
+    {
+        auto result = ForEachLink(pin, [node, pin, &visitor](Link* link)
+        {
+            // Link between two pins of the same node is visited once, from start pin
+            if (link->m_StartPin != pin && link->m_StartPin->m_Node == node)
+                return true;
+
+            return visitor(link);
+        });
+
+        if (!result)
+            return false;
+    }
+
+    return true;
+}
+
+
 //------------------------------------------------------------------------------
 } // namespace Detail
 } // namespace Editor
@@ -0,0 +1,112 @@
+//------------------------------------------------------------------------------
+// LICENSE
+//   This software is dual-licensed to the public domain and under the following
+//   license: you are granted a perpetual, irrevocable license to copy, modify,
+//   publish, and distribute this file as you see fit.
+//------------------------------------------------------------------------------
+# pragma once
+# include <chrono>
+# include <cmath>
+# include <cstdint>
+# include <cstdio>
+
+
+//------------------------------------------------------------------------------
+namespace bench {
+
+
+//------------------------------------------------------------------------------
+struct Context
+{
+    bool Quick    = false; // reduced workload, used by CTest
+    int  Failures = 0;
+};
+
+// Deterministic xorshift generator, every run tests the same data.
+struct Random
+{
+    explicit Random(uint32_t seed): m_State(seed ? seed : 0x9E3779B9u) {}
+
+    uint32_t Next()
+    {
+        m_State ^= m_State << 13;
+        m_State ^= m_State >> 17;
+        m_State ^= m_State << 5;
+        return m_State;
+    }
+
+    float Float(float min, float max)
+    {
+        return min + (max - min) * static_cast<float>(Next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    int Int(int count)
+    {
+        return static_cast<int>(Next() % static_cast<uint32_t>(count));
+    }
+
+private:
+    uint32_t m_State;
+};
+
+// Keeps result of measured code alive.
+inline void DoNotOptimize(float value)
+{
+    static volatile float sink;
+    sink = value;
+    (void)sink;
+}
+
+// Runs 'body' few times and returns best time in nanoseconds per operation.
+template <typename F>
+inline double MeasureNs(int opCount, F&& body, int repeats = 5)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    double best = 0.0;
+    for (int i = 0; i < repeats; ++i)
+    {
+        const auto start = Clock::now();
+        body();
+        const auto time = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        if (i == 0 || time < best)
+            best = time;
+    }
+
+    return opCount > 0 ? best / opCount : 0.0;
+}
+
+inline void PrintHeader(const char* title)
+{
+    printf("\n%s\n", title);
+    printf("    %-30s %-12s %10s %12s %12s\n", "function", "case", "ns/op", "max error", "limit");
+}
+
+// Prints one result row, error over 'limit' counts as failure. Negative limit
+// reports error without checking it.
+inline void Report(Context& context, const char* function, const char* name, double nsPerOp, double maxError, double limit, const char* unit)
+{
+    const bool failed = limit >= 0.0 && !(maxError <= limit); // NaN fails too
+
+    char limitText[32];
+    if (limit >= 0.0)
+        snprintf(limitText, sizeof(limitText), "%.3g", limit);
+    else
+        snprintf(limitText, sizeof(limitText), "-");
+
+    printf("    %-30s %-12s %10.1f %12.3g %12s %-6s%s\n", function, name, nsPerOp, maxError, limitText, unit, failed ? " FAILED" : "");
+
+    if (failed)
+        ++context.Failures;
+}
+
+// Prints benchmark row without error column.
+inline void ReportTime(const char* function, const char* name, double nsPerOp, const char* note = "")
+{
+    printf("    %-30s %-12s %10.1f %12s %12s %s\n", function, name, nsPerOp, "", "", note);
+}
+
+
+//------------------------------------------------------------------------------
+} // namespace bench
@@ -0,0 +1,792 @@
+//------------------------------------------------------------------------------
+// LICENSE
+//   This software is dual-licensed to the public domain and under the following
+//   license: you are granted a perpetual, irrevocable license to copy, modify,
+//   publish, and distribute this file as you see fit.
+//------------------------------------------------------------------------------
+// Accuracy and speed of imgui_bezier_math.h and imgui_extra_math.h functions.
+//
+// Every function is checked against double precision reference on randomized
+// curves and on pathological ones: degenerate (coincident control points),
+// cusps and collinear control points. Batched functions are checked against
+// their scalar counterparts. Errors are in canvas units unless stated
+// otherwise. Limits are set with some headroom over what current code gets,
+// they are meant to catch regressions, not to prove correctness.
+//------------------------------------------------------------------------------
+# include "bench.h"
+# include <imgui_bezier_math.h>
+# include <cfloat>
+# include <vector>
+
+
+//------------------------------------------------------------------------------
+namespace {
+
+struct Vec2d
+{
+    double x, y;
+
+    Vec2d(): x(0.0), y(0.0) {}
+    Vec2d(double x, double y): x(x), y(y) {}
+    Vec2d(const ImVec2& v): x(v.x), y(v.y) {}
+};
+
+inline Vec2d  operator+(const Vec2d& a, const Vec2d& b) { return Vec2d(a.x + b.x, a.y + b.y); }
+inline Vec2d  operator-(const Vec2d& a, const Vec2d& b) { return Vec2d(a.x - b.x, a.y - b.y); }
+inline Vec2d  operator*(const Vec2d& a, double s)       { return Vec2d(a.x * s, a.y * s); }
+inline double Dot(const Vec2d& a, const Vec2d& b)       { return a.x * b.x + a.y * b.y; }
+inline double Length(const Vec2d& a)                    { return sqrt(Dot(a, a)); }
+
+enum CurveKind
+{
+    CurveKind_Random,
+    CurveKind_Degenerate,
+    CurveKind_Cusp,
+    CurveKind_Collinear,
+    CurveKind_Count
+};
+
+const char* const c_CurveKindNames[CurveKind_Count] = { "random", "degenerate", "cusp", "collinear" };
+
+const float c_Extent = 1000.0f; // random curves fit in [-extent, extent] square
+
+
+//------------------------------------------------------------------------------
+// Double precision reference
+//------------------------------------------------------------------------------
+Vec2d BezierD(const ImCubicBezierPoints& c, double t)
+{
+    const auto u = 1.0 - t;
+    return Vec2d(c.P0) * (u * u * u) + Vec2d(c.P1) * (3.0 * u * u * t) + Vec2d(c.P2) * (3.0 * u * t * t) + Vec2d(c.P3) * (t * t * t);
+}
+
+Vec2d BezierDtD(const ImCubicBezierPoints& c, double t)
+{
+    const auto u = 1.0 - t;
+    return (Vec2d(c.P1) - Vec2d(c.P0)) * (3.0 * u * u) + (Vec2d(c.P2) - Vec2d(c.P1)) * (6.0 * u * t) + (Vec2d(c.P3) - Vec2d(c.P2)) * (3.0 * t * t);
+}
+
+// Composite 5 point Gauss-Legendre. Pieces meet at t = 0.5, where cusps of
+// generated curves are.
+double LengthD(const ImCubicBezierPoints& c, double t0 = 0.0, double t1 = 1.0, int pieces = 256)
+{
+    static const double x[5] = { -0.9061798459386640, -0.5384693101056831, 0.0, 0.5384693101056831, 0.9061798459386640 };
+    static const double w[5] = {  0.2369268850561891,  0.4786286704993665, 0.5688888888888889, 0.4786286704993665, 0.2369268850561891 };
+
+    const auto step = (t1 - t0) / pieces;
+
+    double length = 0.0;
+    for (int i = 0; i < pieces; ++i)
+    {
+        const auto center = t0 + (i + 0.5) * step;
+        for (int j = 0; j < 5; ++j)
+            length += w[j] * Length(BezierDtD(c, center + x[j] * step * 0.5)) * step * 0.5;
+    }
+
+    return length;
+}
+
+// Extremes of each coordinate are at roots of derivative.
+void BoundingRectD(const ImCubicBezierPoints& c, Vec2d& min, Vec2d& max)
+{
+    min = Vec2d(fmin(c.P0.x, c.P3.x), fmin(c.P0.y, c.P3.y));
+    max = Vec2d(fmax(c.P0.x, c.P3.x), fmax(c.P0.y, c.P3.y));
+
+    const double p[2][4] = { { c.P0.x, c.P1.x, c.P2.x, c.P3.x }, { c.P0.y, c.P1.y, c.P2.y, c.P3.y } };
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        const auto a = 3.0 * (-p[axis][0] + 3.0 * p[axis][1] - 3.0 * p[axis][2] + p[axis][3]);
+        const auto b = 6.0 * (p[axis][0] - 2.0 * p[axis][1] + p[axis][2]);
+        const auto k = 3.0 * (p[axis][1] - p[axis][0]);
+
+        double roots[2];
+        int    rootCount = 0;
+        if (fabs(a) < 1e-12)
+        {
+            if (fabs(b) > 1e-12)
+                roots[rootCount++] = -k / b;
+        }
+        else
+        {
+            const auto discriminant = b * b - 4.0 * a * k;
+            if (discriminant >= 0.0)
+            {
+                roots[rootCount++] = (-b + sqrt(discriminant)) / (2.0 * a);
+                roots[rootCount++] = (-b - sqrt(discriminant)) / (2.0 * a);
+            }
+        }
+
+        for (int i = 0; i < rootCount; ++i)
+        {
+            if (roots[i] <= 0.0 || roots[i] >= 1.0)
+                continue;
+
+            const auto point = BezierD(c, roots[i]);
+            const auto value = axis == 0 ? point.x : point.y;
+            if (axis == 0) { min.x = fmin(min.x, value); max.x = fmax(max.x, value); }
+            else           { min.y = fmin(min.y, value); max.y = fmax(max.y, value); }
+        }
+    }
+}
+
+// Dense sampling finds basin of global minimum, golden section search polishes it.
+double DistanceD(const Vec2d& point, const ImCubicBezierPoints& c)
+{
+    const int sampleCount = 1024;
+
+    auto distanceAt = [&](double t) { return Length(BezierD(c, t) - point); };
+
+    int    best         = 0;
+    double bestDistance = DBL_MAX;
+    for (int i = 0; i <= sampleCount; ++i)
+    {
+        const auto distance = distanceAt(static_cast<double>(i) / sampleCount);
+        if (distance < bestDistance)
+        {
+            bestDistance = distance;
+            best         = i;
+        }
+    }
+
+    auto lo = static_cast<double>(ImMax(best - 1, 0)) / sampleCount;
+    auto hi = static_cast<double>(ImMin(best + 1, sampleCount)) / sampleCount;
+    const auto ratio = 0.6180339887498949;
+    for (int i = 0; i < 80; ++i)
+    {
+        const auto m1 = hi - (hi - lo) * ratio;
+        const auto m2 = lo + (hi - lo) * ratio;
+        if (distanceAt(m1) < distanceAt(m2))
+            hi = m2;
+        else
+            lo = m1;
+    }
+
+    return fmin(bestDistance, distanceAt((lo + hi) * 0.5));
+}
+
+double DistanceToSegmentD(const Vec2d& p, const Vec2d& a, const Vec2d& b)
+{
+    const auto ab     = b - a;
+    const auto lengthSq = Dot(ab, ab);
+    const auto t      = lengthSq > 0.0 ? fmin(fmax(Dot(p - a, ab) / lengthSq, 0.0), 1.0) : 0.0;
+    return Length(p - (a + ab * t));
+}
+
+double DistanceToRectD(const Vec2d& p, const ImRect& r)
+{
+    const auto dx = fmax(fmax(r.Min.x - p.x, p.x - r.Max.x), 0.0);
+    const auto dy = fmax(fmax(r.Min.y - p.y, p.y - r.Max.y), 0.0);
+    return sqrt(dx * dx + dy * dy);
+}
+
+
+//------------------------------------------------------------------------------
+// Test data
+//------------------------------------------------------------------------------
+ImVec2 RandomPoint(bench::Random& random, float extent)
+{
+    return ImVec2(random.Float(-extent, extent), random.Float(-extent, extent));
+}
+
+ImCubicBezierPoints GenerateCurve(bench::Random& random, CurveKind kind)
+{
+    switch (kind)
+    {
+        default:
+        case CurveKind_Random:
+            return ImCubicBezierPoints{ RandomPoint(random, c_Extent), RandomPoint(random, c_Extent), RandomPoint(random, c_Extent), RandomPoint(random, c_Extent) };
+
+        case CurveKind_Degenerate:
+        {
+            // Each variant has some control points in the same place
+            const auto a = RandomPoint(random, c_Extent);
+            const auto b = RandomPoint(random, c_Extent);
+            const auto c = RandomPoint(random, c_Extent);
+            switch (random.Int(5))
+            {
+                default:
+                case 0: return ImCubicBezierPoints{ a, a, a, a }; // point
+                case 1: return ImCubicBezierPoints{ a, a, b, b }; // straight line, zero speed at ends
+                case 2: return ImCubicBezierPoints{ a, b, c, a }; // closed loop
+                case 3: return ImCubicBezierPoints{ a, b, b, c }; // coincident handles
+                case 4: return ImCubicBezierPoints{ a, a, a, b }; // two handles at start
+            }
+        }
+
+        case CurveKind_Cusp:
+        {
+            // (0, 0), (1, 1), (0, 1), (1, 0) has cusp at t = 0.5, affine
+            // transform keeps it there
+            const auto origin = RandomPoint(random, c_Extent * 0.5f);
+            const auto axisX  = RandomPoint(random, c_Extent * 0.5f);
+            const auto axisY  = RandomPoint(random, c_Extent * 0.5f);
+            return ImCubicBezierPoints{ origin, origin + axisX + axisY, origin + axisY, origin + axisX };
+        }
+
+        case CurveKind_Collinear:
+        {
+            // Control points anywhere on the line, curve may go back and forth
+            const auto origin    = RandomPoint(random, c_Extent * 0.5f);
+            const auto direction = RandomPoint(random, 1.0f);
+            auto onLine = [&]() { return origin + direction * random.Float(-c_Extent * 0.5f, c_Extent * 0.5f); };
+            return ImCubicBezierPoints{ onLine(), onLine(), onLine(), onLine() };
+        }
+    }
+}
+
+std::vector<ImCubicBezierPoints> GenerateCurves(bench::Random& random, CurveKind kind, int count)
+{
+    std::vector<ImCubicBezierPoints> curves(count);
+    for (auto& curve : curves)
+        curve = GenerateCurve(random, kind);
+    return curves;
+}
+
+// Points scattered around the curve, many close enough to make near test and
+// projection work for the answer.
+ImVec2 GenerateQueryPoint(bench::Random& random, const ImCubicBezierPoints& curve, float spread)
+{
+    const auto t = random.Float(0.0f, 1.0f);
+    return ImCubicBezier(curve.P0, curve.P1, curve.P2, curve.P3, t) + RandomPoint(random, spread);
+}
+
+
+//------------------------------------------------------------------------------
+// Tests
+//------------------------------------------------------------------------------
+struct Suite
+{
+    bench::Context& Context;
+    int             CurveCount;
+    std::vector<ImCubicBezierPoints> Curves[CurveKind_Count];
+
+    Suite(bench::Context& context)
+        : Context(context)
+        , CurveCount(context.Quick ? 256 : 4096)
+    {
+        bench::Random random(1);
+        for (int kind = 0; kind < CurveKind_Count; ++kind)
+            Curves[kind] = GenerateCurves(random, static_cast<CurveKind>(kind), CurveCount);
+    }
+};
+
+// Batched evaluation against ImCubicBezier() and ImCubicBezierDt() called in
+// a loop. Results match exactly unless compiler fuses multiply and add in the
+// scalar code. Parameter count is not multiple of four, so tail is covered too.
+template <typename Batch, typename Scalar>
+void TestBatch(Suite& suite, const char* batchName, const char* scalarName, Batch batch, Scalar scalar)
+{
+    const int paramCount = 63;
+
+    std::vector<float> params(paramCount);
+    for (int i = 0; i < paramCount; ++i)
+        params[i] = static_cast<float>(i) / (paramCount - 1);
+
+    for (int kind = 0; kind < CurveKind_Count; ++kind)
+    {
+        const auto& curves     = suite.Curves[kind];
+        const int   curveCount = static_cast<int>(curves.size());
+        const int   valueCount = curveCount * paramCount;
+
+        std::vector<ImVec2> values(valueCount);
+        batch(curves.data(), curveCount, params.data(), paramCount, values.data());
+
+        double maxError = 0.0;
+        for (int i = 0; i < curveCount; ++i)
+        {
+            for (int j = 0; j < paramCount; ++j)
+            {
+                const auto& curve     = curves[i];
+                const auto  reference = scalar(curve.P0, curve.P1, curve.P2, curve.P3, params[j]);
+                maxError = fmax(maxError, Length(Vec2d(values[i * paramCount + j]) - Vec2d(reference)));
+            }
+        }
+
+        const auto batchNs = bench::MeasureNs(valueCount, [&]
+        {
+            batch(curves.data(), curveCount, params.data(), paramCount, values.data());
+            bench::DoNotOptimize(values[valueCount / 2].x);
+        });
+
+        const auto scalarNs = bench::MeasureNs(valueCount, [&]
+        {
+            auto out = values.data();
+            for (const auto& curve : curves)
+                for (int j = 0; j < paramCount; ++j)
+                    *out++ = scalar(curve.P0, curve.P1, curve.P2, curve.P3, params[j]);
+            bench::DoNotOptimize(values[valueCount / 2].x);
+        });
+
+        bench::Report(suite.Context, batchName, c_CurveKindNames[kind], batchNs, maxError, 1e-3, "px");
+        bench::ReportTime(scalarName, c_CurveKindNames[kind], scalarNs, "scalar loop");
+    }
+}
+
+void TestCubicBezierN(Suite& suite)
+{
+    TestBatch(suite, "ImCubicBezierN", "ImCubicBezier",
+        [](const ImCubicBezierPoints* curves, int curveCount, const float* t, int tCount, ImVec2* out) { ImCubicBezierN(curves, curveCount, t, tCount, out); },
+        [](const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, float t) { return ImCubicBezier(p0, p1, p2, p3, t); });
+}
+
+void TestCubicBezierDtN(Suite& suite)
+{
+    TestBatch(suite, "ImCubicBezierDtN", "ImCubicBezierDt",
+        [](const ImCubicBezierPoints* curves, int curveCount, const float* t, int tCount, ImVec2* out) { ImCubicBezierDtN(curves, curveCount, t, tCount, out); },
+        [](const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, float t) { return ImCubicBezierDt(p0, p1, p2, p3, t); });
+}
+
+void TestLength(Suite& suite)
+{
+    // Fixed 24 point Gauss-Legendre quadrature, curves with sharp turns
+    // need more points than that
+    const double limits[CurveKind_Count] = { 5e-3, 5e-3, 5e-3, 1e-2 };
+
+    for (int kind = 0; kind < CurveKind_Count; ++kind)
+    {
+        const auto& curves = suite.Curves[kind];
+
+        // Relative to length, absolute for very short curves
+        double maxError = 0.0;
+        for (const auto& curve : curves)
+        {
+            const auto reference = LengthD(curve);
+            const auto error     = fabs(ImCubicBezierLength(curve) - reference) / fmax(reference, 1.0);
+            maxError = fmax(maxError, error);
+        }
+
+        const auto ns = bench::MeasureNs(static_cast<int>(curves.size()), [&]
+        {
+            float sum = 0.0f;
+            for (const auto& curve : curves)
+                sum += ImCubicBezierLength(curve);
+            bench::DoNotOptimize(sum);
+        });
+
+        bench::Report(suite.Context, "ImCubicBezierLength", c_CurveKindNames[kind], ns, maxError, limits[kind], "rel");
+    }
+}
+
+void TestBoundingRect(Suite& suite)
+{
+    for (int kind = 0; kind < CurveKind_Count; ++kind)
+    {
+        const auto& curves = suite.Curves[kind];
+
+        double maxError = 0.0;
+        for (const auto& curve : curves)
+        {
+            Vec2d min, max;
+            BoundingRectD(curve, min, max);
+
+            const auto rect = ImCubicBezierBoundingRect(curve);
+            maxError = fmax(maxError, fabs(rect.Min.x - min.x));
+            maxError = fmax(maxError, fabs(rect.Min.y - min.y));
+            maxError = fmax(maxError, fabs(rect.Max.x - max.x));
+            maxError = fmax(maxError, fabs(rect.Max.y - max.y));
+        }
+
+        const auto ns = bench::MeasureNs(static_cast<int>(curves.size()), [&]
+        {
+            float sum = 0.0f;
+            for (const auto& curve : curves)
+                sum += ImCubicBezierBoundingRect(curve).Max.x;
+            bench::DoNotOptimize(sum);
+        });
+
+        bench::Report(suite.Context, "ImCubicBezierBoundingRect", c_CurveKindNames[kind], ns, maxError, 1e-2, "px");
+    }
+}
+
+void TestProject(Suite& suite)
+{
+    bench::Random random(2);
+
+    for (int kind = 0; kind < CurveKind_Count; ++kind)
+    {
+        const auto& curves = suite.Curves[kind];
+
+        std::vector<ImVec2> points(curves.size());
+        for (size_t i = 0; i < curves.size(); ++i)
+            points[i] = GenerateQueryPoint(random, curves[i], 200.0f);
+
+        // Error is how much farther projected point is than the closest one
+        double maxError = 0.0;
+        for (size_t i = 0; i < curves.size(); ++i)
+        {
+            const auto result    = ImProjectOnCubicBezier(points[i], curves[i]);
+            const auto reference = DistanceD(points[i], curves[i]);
+            const auto distance  = Length(BezierD(curves[i], result.Time) - Vec2d(points[i]));
+            maxError = fmax(maxError, distance - reference);
+            maxError = fmax(maxError, fabs(result.Distance - distance));
+        }
+
+        const auto ns = bench::MeasureNs(static_cast<int>(curves.size()), [&]
+        {
+            float sum = 0.0f;
+            for (size_t i = 0; i < curves.size(); ++i)
+                sum += ImProjectOnCubicBezier(points[i], curves[i]).Distance;
+            bench::DoNotOptimize(sum);
+        });
+
+        bench::Report(suite.Context, "ImProjectOnCubicBezier", c_CurveKindNames[kind], ns, maxError, 1e-2, "px");
+    }
+}
+
+void TestIsPointNear(Suite& suite)
+{
+    const float maxDistance = 5.0f;
+    const float ambiguity   = 1e-2f; // answer is not checked that close to the limit
+
+    bench::Random random(3);
+
+    for (int kind = 0; kind < CurveKind_Count; ++kind)
+    {
+        const auto& curves = suite.Curves[kind];
+
+        std::vector<ImVec2> points(curves.size());
+        for (size_t i = 0; i < curves.size(); ++i)
+            points[i] = GenerateQueryPoint(random, curves[i], 2.0f * maxDistance);
+
+        int mismatches = 0, checked = 0;
+        for (size_t i = 0; i < curves.size(); ++i)
+        {
+            const auto reference = DistanceD(points[i], curves[i]);
+            if (fabs(reference - maxDistance) < ambiguity)
+                continue;
+
+            ++checked;
+            if (ImCubicBezierIsPointNear(points[i], curves[i], maxDistance) != (reference <= maxDistance))
+                ++mismatches;
+        }
+
+        const auto ns = bench::MeasureNs(static_cast<int>(curves.size()), [&]
+        {
+            int count = 0;
+            for (size_t i = 0; i < curves.size(); ++i)
+                count += ImCubicBezierIsPointNear(points[i], curves[i], maxDistance) ? 1 : 0;
+            bench::DoNotOptimize(static_cast<float>(count));
+        });
+
+        const auto wrong = 100.0 * mismatches / ImMax(checked, 1);
+        bench::Report(suite.Context, "ImCubicBezierIsPointNear", c_CurveKindNames[kind], ns, wrong, 0.1, "%");
+    }
+}
+
+void TestLineIntersect(Suite& suite)
+{
+    bench::Random random(4);
+
+    for (int kind = 0; kind < CurveKind_Count; ++kind)
+    {
+        const auto& curves = suite.Curves[kind];
+
+        // Segments cross curve somewhere, end points are scattered around it
+        std::vector<ImLine> lines(curves.size());
+        for (size_t i = 0; i < curves.size(); ++i)
+        {
+            lines[i].A = GenerateQueryPoint(random, curves[i], 300.0f);
+            lines[i].B = GenerateQueryPoint(random, curves[i], 300.0f);
+        }
+
+        // Reference roots of signed distance from the line are found by
+        // sampling and bisection. Cases with curve touching the line or
+        // crossing near segment end are skipped, float answer is not
+        // reliable there.
+        const int sampleCount = 2048;
+
+        int    mismatches = 0;
+        double maxError   = 0.0;
+        for (size_t i = 0; i < curves.size(); ++i)
+        {
+            const auto& curve = curves[i];
+            const auto  a     = Vec2d(lines[i].A);
+            const auto  ab    = Vec2d(lines[i].B) - a;
+            const auto  span  = Length(ab);
+            if (span < 1e-3)
+                continue;
+
+            const auto normal = Vec2d(-ab.y / span, ab.x / span);
+            auto signedDistance = [&](double t) { return Dot(BezierD(curve, t) - a, normal); };
+
+            Vec2d roots[3 * 4];
+            int   rootCount = 0;
+            bool  ambiguous = false;
+
+            auto previous = signedDistance(0.0);
+            for (int j = 1; j <= sampleCount && !ambiguous; ++j)
+            {
+                const auto t0 = static_cast<double>(j - 1) / sampleCount;
+                const auto t1 = static_cast<double>(j) / sampleCount;
+                const auto current = signedDistance(t1);
+
+                if (fabs(current) < 1e-2)
+                    ambiguous = true; // touching or crossing at sample, skip
+                else if ((previous < 0.0) != (current < 0.0))
+                {
+                    auto lo = t0, hi = t1;
+                    for (int k = 0; k < 60; ++k)
+                    {
+                        const auto mid = (lo + hi) * 0.5;
+                        if ((signedDistance(mid) < 0.0) == (previous < 0.0))
+                            lo = mid;
+                        else
+                            hi = mid;
+                    }
+
+                    const auto point = BezierD(curve, (lo + hi) * 0.5);
+                    const auto along = Dot(point - a, ab) / (span * span);
+                    if (fabs(along) < 1e-3 || fabs(along - 1.0) < 1e-3 || rootCount == 3)
+                        ambiguous = true;
+                    else if (along > 0.0 && along < 1.0)
+                        roots[rootCount++] = point;
+                }
+
+                previous = current;
+            }
+
+            if (ambiguous)
+                continue;
+
+            const auto result = ImCubicBezierLineIntersect(curve, lines[i]);
+            if (result.Count != rootCount)
+            {
+                ++mismatches;
+                continue;
+            }
+
+            for (int j = 0; j < result.Count; ++j)
+            {
+                auto closest = DBL_MAX;
+                for (int k = 0; k < rootCount; ++k)
+                    closest = fmin(closest, Length(Vec2d(result.Points[j]) - roots[k]));
+                maxError = fmax(maxError, closest);
+            }
+        }
+
+        const auto ns = bench::MeasureNs(static_cast<int>(curves.size()), [&]
+        {
+            int count = 0;
+            for (size_t i = 0; i < curves.size(); ++i)
+                count += ImCubicBezierLineIntersect(curves[i], lines[i]).Count;
+            bench::DoNotOptimize(static_cast<float>(count));
+        });
+
+        // Roots come from float Cardano formula and lose precision on curves
+        // close to quadratic or linear, editor does not use this function,
+        // so error is only reported.
+        bench::Report(suite.Context, "ImCubicBezierLineIntersect", c_CurveKindNames[kind], ns, maxError, -1.0, "px");
+        bench::Report(suite.Context, "ImCubicBezierLineIntersect", c_CurveKindNames[kind], ns, mismatches, -1.0, "wrong");
+    }
+}
+
+void TestRectIntersect(Suite& suite)
+{
+    bench::Random random(5);
+
+    for (int kind = 0; kind < CurveKind_Count; ++kind)
+    {
+        const auto& curves = suite.Curves[kind];
+
+        std::vector<ImRect> rects(curves.size());
+        for (size_t i = 0; i < curves.size(); ++i)
+        {
+            const auto center = GenerateQueryPoint(random, curves[i], 200.0f);
+            const auto size   = ImVec2(random.Float(1.0f, 200.0f), random.Float(1.0f, 200.0f));
+            rects[i] = ImRect(center - size * 0.5f, center + size * 0.5f);
+        }
+
+        // Curve hits rectangle when its closest point is inside, cases with
+        // curve passing close to the edge are skipped
+        int mismatches = 0;
+        for (size_t i = 0; i < curves.size(); ++i)
+        {
+            const int sampleCount = 2048;
+
+            auto closest = DBL_MAX;
+            for (int j = 0; j <= sampleCount && closest > 0.0; ++j)
+                closest = fmin(closest, DistanceToRectD(BezierD(curves[i], static_cast<double>(j) / sampleCount), rects[i]));
+
+            const auto step = LengthD(curves[i], 0.0, 1.0, 16) / sampleCount;
+            if (closest > 0.0 && closest < step + 1e-2)
+                continue;
+
+            if (ImCubicBezierRectIntersect(curves[i], rects[i]) != (closest <= 0.0))
+                ++mismatches;
+        }
+
+        const auto ns = bench::MeasureNs(static_cast<int>(curves.size()), [&]
+        {
+            int count = 0;
+            for (size_t i = 0; i < curves.size(); ++i)
+                count += ImCubicBezierRectIntersect(curves[i], rects[i]) ? 1 : 0;
+            bench::DoNotOptimize(static_cast<float>(count));
+        });
+
+        bench::Report(suite.Context, "ImCubicBezierRectIntersect", c_CurveKindNames[kind], ns, mismatches, 0, "wrong");
+    }
+}
+
+void TestFixedStep(Suite& suite)
+{
+    for (int kind = 0; kind < CurveKind_Count; ++kind)
+    {
+        const auto& curves = suite.Curves[kind];
+
+        // Error is difference of arc length at returned sample from requested
+        // one, relative to curve length. Sample positions come from
+        // ImCubicBezierLength() so they share its error.
+        double maxError    = 0.0;
+        int    sampleCount = 0;
+        for (const auto& curve : curves)
+        {
+            const auto length = LengthD(curve);
+            const auto step   = ImMax(static_cast<float>(length) / 12.0f, 1.0f);
+
+            int index = 0;
+            auto callback = [&](ImCubicBezierFixedStepSample& sample)
+            {
+                const auto reference = LengthD(curve, 0.0, sample.T, 64);
+                maxError = fmax(maxError, fabs(reference - index * static_cast<double>(step)) / fmax(length, 1.0));
+                ++index;
+            };
+
+            ImCubicBezierFixedStep(callback, curve, step);
+
+            sampleCount += index;
+        }
+
+        const auto ns = bench::MeasureNs(sampleCount, [&]
+        {
+            float sum = 0.0f;
+            for (const auto& curve : curves)
+            {
+                const auto step = ImMax(ImCubicBezierLength(curve) / 12.0f, 1.0f);
+                auto callback = [&sum](ImCubicBezierFixedStepSample& sample) { sum += sample.Point.x; };
+                ImCubicBezierFixedStep(callback, curve, step);
+            }
+            bench::DoNotOptimize(sum);
+        }, 2);
+
+        bench::Report(suite.Context, "ImCubicBezierFixedStep", c_CurveKindNames[kind], ns, maxError, 1e-2, "rel");
+    }
+}
+
+void TestSubdivide(Suite& suite)
+{
+    const float tolerance = 1.0f;
+
+    for (int kind = 0; kind < CurveKind_Count; ++kind)
+    {
+        const auto& curves = suite.Curves[kind];
+
+        // Pieces are split until control points are closer than 'tolerance'
+        // to the chord, which keeps curve within 3/4 of it. Error is the
+        // farthest curve gets from emitted polyline.
+        double maxError   = 0.0;
+        int    pointCount = 0;
+        std::vector<Vec2d> polyline;
+        for (const auto& curve : curves)
+        {
+            polyline.resize(0);
+            auto callback = [&polyline](const ImCubicBezierSubdivideSample& sample) { polyline.push_back(Vec2d(sample.Point)); };
+            ImCubicBezierSubdivide(callback, curve, tolerance);
+
+            pointCount += static_cast<int>(polyline.size());
+
+            const auto end = Vec2d(curve.P3) - polyline.back();
+            maxError = fmax(maxError, Length(end));
+
+            const int sampleCount = 256;
+            for (int j = 0; j <= sampleCount; ++j)
+            {
+                const auto point = BezierD(curve, static_cast<double>(j) / sampleCount);
+
+                auto closest = DBL_MAX;
+                for (size_t k = 1; k < polyline.size(); ++k)
+                    closest = fmin(closest, DistanceToSegmentD(point, polyline[k - 1], polyline[k]));
+                if (polyline.size() == 1)
+                    closest = Length(point - polyline[0]);
+
+                maxError = fmax(maxError, closest);
+            }
+        }
+
+        const auto ns = bench::MeasureNs(pointCount, [&]
+        {
+            float sum = 0.0f;
+            auto callback = [&sum](const ImCubicBezierSubdivideSample& sample) { sum += sample.Point.x; };
+            for (const auto& curve : curves)
+                ImCubicBezierSubdivide(callback, curve, tolerance);
+            bench::DoNotOptimize(sum);
+        });
+
+        bench::Report(suite.Context, "ImCubicBezierSubdivide", c_CurveKindNames[kind], ns, maxError, 0.75 * tolerance + 1e-2, "px");
+    }
+}
+
+void TestRectClosestLine(Suite& suite)
+{
+    bench::Random random(6);
+
+    const int count = suite.CurveCount;
+
+    // Pairs are separated, overlap on one axis or overlap completely
+    std::vector<ImRect> rectsA(count), rectsB(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const auto a = RandomPoint(random, c_Extent);
+        const auto b = random.Int(4) == 0 ? a + RandomPoint(random, 50.0f) : RandomPoint(random, c_Extent);
+        rectsA[i] = ImRect(a, a + ImVec2(random.Float(1.0f, 300.0f), random.Float(1.0f, 300.0f)));
+        rectsB[i] = ImRect(b, b + ImVec2(random.Float(1.0f, 300.0f), random.Float(1.0f, 300.0f)));
+    }
+
+    // Line is as long as distance between rectangles and its ends lie on them
+    double maxError = 0.0;
+    for (int i = 0; i < count; ++i)
+    {
+        const auto& a = rectsA[i];
+        const auto& b = rectsB[i];
+
+        const auto dx = fmax(fmax(static_cast<double>(b.Min.x) - a.Max.x, static_cast<double>(a.Min.x) - b.Max.x), 0.0);
+        const auto dy = fmax(fmax(static_cast<double>(b.Min.y) - a.Max.y, static_cast<double>(a.Min.y) - b.Max.y), 0.0);
+
+        const auto line = ImRect_ClosestLine(a, b);
+        maxError = fmax(maxError, fabs(Length(Vec2d(line.B) - Vec2d(line.A)) - sqrt(dx * dx + dy * dy)));
+        maxError = fmax(maxError, DistanceToRectD(Vec2d(line.A), a));
+        maxError = fmax(maxError, DistanceToRectD(Vec2d(line.B), b));
+    }
+
+    const auto ns = bench::MeasureNs(count, [&]
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < count; ++i)
+            sum += ImRect_ClosestLine(rectsA[i], rectsB[i]).A.x;
+        bench::DoNotOptimize(sum);
+    });
+
+    bench::Report(suite.Context, "ImRect_ClosestLine", "random", ns, maxError, 1e-3, "px");
+}
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+void RunBezierMathTests(bench::Context& context)
+{
+    Suite suite(context);
+
+    bench::PrintHeader("Bezier math");
+
+    TestCubicBezierN(suite);
+    TestCubicBezierDtN(suite);
+    TestLength(suite);
+    TestBoundingRect(suite);
+    TestProject(suite);
+    TestIsPointNear(suite);
+    TestLineIntersect(suite);
+    TestRectIntersect(suite);
+    TestFixedStep(suite);
+    TestSubdivide(suite);
+    TestRectClosestLine(suite);
+}
@@ -0,0 +1,188 @@
+//------------------------------------------------------------------------------
+// LICENSE
+//   This software is dual-licensed to the public domain and under the following
+//   license: you are granted a perpetual, irrevocable license to copy, modify,
+//   publish, and distribute this file as you see fit.
+//------------------------------------------------------------------------------
+// Cached link geometry.
+//
+// Headless editor draws graph of static links zoomed out to fit, so every
+// link is visible. Frames with links replayed from cache are compared with
+// frames where link color flips every frame, which makes every link miss the
+// cache, tessellate and store geometry again. Draw data of both has to be
+// the same.
+//------------------------------------------------------------------------------
+# include "bench.h"
+# include <imgui.h>
+# include <imgui_node_editor.h>
+# include <vector>
+
+
+//------------------------------------------------------------------------------
+namespace {
+
+namespace ed = ax::NodeEditor;
+
+struct LinkInfo
+{
+    int Id;
+    int StartPinId;
+    int EndPinId;
+};
+
+struct Graph
+{
+    int                   NodeCount;
+    std::vector<LinkInfo> Links;
+};
+
+// Each node has one input and one output pin, every output pin starts
+// 'linksPerPin' links ending at random nodes.
+Graph GenerateGraph(int linkCount, int linksPerPin)
+{
+    bench::Random random(static_cast<uint32_t>(linkCount));
+
+    Graph graph;
+    graph.NodeCount = linkCount / linksPerPin;
+    graph.Links.resize(linkCount);
+
+    for (int i = 0; i < linkCount; ++i)
+    {
+        const auto startNode = i / linksPerPin;
+        const auto endNode   = random.Int(graph.NodeCount);
+
+        graph.Links[i] = LinkInfo{ 1 + i, 2 * graph.NodeCount + 1 + startNode * 2 + 1, 2 * graph.NodeCount + 1 + endNode * 2 };
+    }
+
+    return graph;
+}
+
+void DrawFrame(ed::EditorContext* editor, const Graph& graph, ImU32 linkColor, int frame)
+{
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+    ImGui::Begin("Benchmark", nullptr, ImGuiWindowFlags_NoDecoration);
+
+    ed::SetCurrentEditor(editor);
+    ed::Begin("Editor");
+
+    const int columns = 45;
+    for (int i = 0; i < graph.NodeCount; ++i)
+    {
+        const auto nodeId = 1 + i;
+        if (frame == 0)
+            ed::SetNodePosition(nodeId, ImVec2((i % columns) * 250.0f, (i / columns) * 100.0f));
+
+        ed::BeginNode(nodeId);
+        ed::BeginPin(2 * graph.NodeCount + 1 + i * 2, ed::PinKind::Input);
+        ImGui::TextUnformatted("in");
+        ed::EndPin();
+        ImGui::SameLine();
+        ed::BeginPin(2 * graph.NodeCount + 1 + i * 2 + 1, ed::PinKind::Output);
+        ImGui::TextUnformatted("out");
+        ed::EndPin();
+        ed::EndNode();
+    }
+
+    const auto color = ImGui::ColorConvertU32ToFloat4(linkColor);
+    for (auto& link : graph.Links)
+        ed::Link(link.Id, link.StartPinId, link.EndPinId, color, 2.0f);
+
+    if (frame == 1)
+        ed::NavigateToContent(0.0f);
+
+    ed::End();
+    ed::SetCurrentEditor(nullptr);
+
+    ImGui::End();
+    ImGui::Render();
+}
+
+uint64_t HashDrawData(const ImDrawData* drawData)
+{
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](const void* data, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ static_cast<const unsigned char*>(data)[i]) * 1099511628211ull;
+    };
+
+    for (int i = 0; i < drawData->CmdListsCount; ++i)
+    {
+        const auto list = drawData->CmdLists[i];
+        mix(list->VtxBuffer.Data, list->VtxBuffer.size_in_bytes());
+        mix(list->IdxBuffer.Data, list->IdxBuffer.size_in_bytes());
+    }
+
+    return hash;
+}
+
+void TestLinkCache(bench::Context& context, int linkCount, const char* name)
+{
+    const auto graph = GenerateGraph(linkCount, 10);
+
+    auto imgui = ImGui::CreateContext();
+    auto& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+    io.DeltaTime   = 1.0f / 60.0f;
+    io.IniFilename = nullptr;
+
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    ed::Config config;
+    config.SettingsFile = nullptr;
+    auto editor = ed::CreateEditor(&config);
+
+    const ImU32 colors[2] = { IM_COL32(255, 255, 255, 255), IM_COL32(255, 255, 254, 255) };
+
+    int frame = 0;
+    for (; frame < 4; ++frame)
+        DrawFrame(editor, graph, colors[0], frame);
+
+    const auto cachedNs = bench::MeasureNs(linkCount, [&]
+    {
+        DrawFrame(editor, graph, colors[0], frame++);
+    }, 8);
+
+    const auto cachedHash  = HashDrawData(ImGui::GetDrawData());
+    const auto vertexCount = ImGui::GetDrawData()->TotalVtxCount;
+
+    int flips = 0;
+    const auto uncachedNs = bench::MeasureNs(linkCount, [&]
+    {
+        DrawFrame(editor, graph, colors[++flips & 1], frame++);
+    }, 8);
+
+    // Links were just tessellated again in original color
+    if (flips & 1)
+        DrawFrame(editor, graph, colors[0], frame++);
+
+    const auto mismatches = HashDrawData(ImGui::GetDrawData()) != cachedHash ? 1 : 0;
+
+    ed::DestroyEditor(editor);
+    ImGui::DestroyContext(imgui);
+
+    char note[64];
+    snprintf(note, sizeof(note), "%.2f ms vs %.2f ms per frame, %dk vertices", uncachedNs * linkCount * 1e-6, cachedNs * linkCount * 1e-6, vertexCount / 1000);
+    bench::Report(context, "Link cache replay", name, cachedNs, mismatches, 0, "wrong");
+    bench::ReportTime("Link tessellation", name, uncachedNs, note);
+}
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+void RunLinkCacheTests(bench::Context& context)
+{
+    bench::PrintHeader("Link geometry cache, time per link");
+
+    TestLinkCache(context, 2000, "2k links");
+
+    if (context.Quick)
+        return;
+
+    TestLinkCache(context, 20000, "20k links");
+}
@@ -0,0 +1,45 @@
+//------------------------------------------------------------------------------
+// LICENSE
+//   This software is dual-licensed to the public domain and under the following
+//   license: you are granted a perpetual, irrevocable license to copy, modify,
+//   publish, and distribute this file as you see fit.
+//------------------------------------------------------------------------------
+# include "bench.h"
+# include <cstring>
+
+void RunBezierMathTests(bench::Context& context);
+void RunLinkCacheTests(bench::Context& context);
+void RunObjectIndexTests(bench::Context& context);
+void RunSpatialGridTests(bench::Context& context);
+void RunTransformTests(bench::Context& context);
+
+int main(int argc, char** argv)
+{
+    bench::Context context;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--quick") == 0)
+            context.Quick = true;
+        else
+        {
+            printf("usage: %s [--quick]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    RunBezierMathTests(context);
+    RunObjectIndexTests(context);
+    RunSpatialGridTests(context);
+    RunLinkCacheTests(context);
+    RunTransformTests(context);
+
+    if (context.Failures > 0)
+    {
+        printf("\n%d check(s) FAILED\n", context.Failures);
+        return 1;
+    }
+
+    printf("\nAll checks passed\n");
+    return 0;
+}
@@ -0,0 +1,185 @@
+//------------------------------------------------------------------------------
+// LICENSE
+//   This software is dual-licensed to the public domain and under the following
+//   license: you are granted a perpetual, irrevocable license to copy, modify,
+//   publish, and distribute this file as you see fit.
+//------------------------------------------------------------------------------
+// Id lookup of editor objects.
+//
+// ObjectIndex is compared with what editor did before: linear scan of nodes
+// and binary search over pins and links, which were sorted again on every
+// insertion. Ids are either small sequential integers or pointer like values,
+// both are common in applications.
+//------------------------------------------------------------------------------
+# include "bench.h"
+# include <imgui_node_editor_internal.h>
+
+
+//------------------------------------------------------------------------------
+namespace {
+
+namespace ed = ax::NodeEditor::Detail;
+
+struct Item
+{
+    ed::NodeId m_ID;
+};
+
+using Index   = ed::ObjectIndex<Item, ed::NodeId>;
+using Wrapper = ed::ObjectWrapper<Item, ed::NodeId>;
+
+void Shuffle(bench::Random& random, std::vector<Item*>& items)
+{
+    for (int i = static_cast<int>(items.size()) - 1; i > 0; --i)
+        std::swap(items[i], items[random.Int(i + 1)]);
+}
+
+void TestObjectIndex(bench::Context& context, int count, bool pointerIds, const char* name)
+{
+    bench::Random random(static_cast<uint32_t>(count) * 2 + (pointerIds ? 1 : 0));
+
+    // Second half of ids is never inserted, used to look up missing objects
+    std::vector<Item> items(count * 2);
+    for (int i = 0; i < count * 2; ++i)
+        items[i].m_ID = pointerIds ? ed::NodeId(0x7F0000100000ull + i * 0x1A0ull) : ed::NodeId(i + 1);
+
+    std::vector<Item*> present(count), missing(count);
+    for (int i = 0; i < count; ++i)
+    {
+        present[i] = &items[i];
+        missing[i] = &items[count + i];
+    }
+    Shuffle(random, present);
+    Shuffle(random, missing);
+
+    // Build
+    Index index;
+    const auto insertNs = bench::MeasureNs(count, [&]
+    {
+        index.Clear();
+        for (auto item : present)
+            index.Insert(item->m_ID, item);
+    });
+
+    // Look up
+    Shuffle(random, present);
+
+    int mismatches = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (index.Find(present[i]->m_ID) != present[i])
+            ++mismatches;
+        if (index.Find(missing[i]->m_ID) != nullptr)
+            ++mismatches;
+    }
+
+    const auto findNs = bench::MeasureNs(count, [&]
+    {
+        int found = 0;
+        for (auto item : present)
+            found += index.Find(item->m_ID) == item ? 1 : 0;
+        bench::DoNotOptimize(static_cast<float>(found));
+    });
+
+    const auto missNs = bench::MeasureNs(count, [&]
+    {
+        int found = 0;
+        for (auto item : missing)
+            found += index.Find(item->m_ID) ? 1 : 0;
+        bench::DoNotOptimize(static_cast<float>(found));
+    });
+
+    // Remove half of objects, other half has to stay reachable
+    const auto removeCount = count / 2;
+    const auto removeNs = bench::MeasureNs(removeCount, [&]
+    {
+        for (int i = 0; i < removeCount; ++i)
+            index.Remove(present[i]->m_ID);
+        for (int i = 0; i < removeCount; ++i)
+            index.Insert(present[i]->m_ID, present[i]);
+    }) * 0.5;
+
+    for (int i = 0; i < removeCount; ++i)
+        index.Remove(present[i]->m_ID);
+    for (int i = 0; i < count; ++i)
+        if (index.Find(present[i]->m_ID) != (i < removeCount ? nullptr : present[i]))
+            ++mismatches;
+    if (static_cast<int>(index.Size()) != count - removeCount)
+        ++mismatches;
+
+    // Previous lookups: sorted vector for pins and links, plain one for nodes
+    std::vector<Wrapper> sorted(count);
+    for (int i = 0; i < count; ++i)
+        sorted[i] = Wrapper{ present[i]->m_ID, present[i] };
+    std::sort(sorted.begin(), sorted.end());
+
+    const auto binaryNs = bench::MeasureNs(count, [&]
+    {
+        int found = 0;
+        for (auto item : present)
+        {
+            const auto key = Wrapper{ item->m_ID, nullptr };
+            const auto it  = std::lower_bound(sorted.begin(), sorted.end(), key);
+            found += (it != sorted.end() && it->m_ID == item->m_ID) ? 1 : 0;
+        }
+        bench::DoNotOptimize(static_cast<float>(found));
+    });
+
+    const auto scanCount = ImMin(count, 256);
+    const auto linearNs = bench::MeasureNs(scanCount, [&]
+    {
+        int found = 0;
+        for (int i = 0; i < scanCount; ++i)
+        {
+            for (auto& wrapper : sorted)
+            {
+                if (wrapper.m_ID == present[i]->m_ID)
+                {
+                    found += 1;
+                    break;
+                }
+            }
+        }
+        bench::DoNotOptimize(static_cast<float>(found));
+    });
+
+    // Insertion used to sort container again, measured for last few objects
+    const auto sortCount = ImMin(count, 16);
+    const auto sortNs = bench::MeasureNs(sortCount, [&]
+    {
+        sorted.resize(count - sortCount);
+        for (int i = count - sortCount; i < count; ++i)
+        {
+            sorted.push_back(Wrapper{ present[i]->m_ID, present[i] });
+            std::sort(sorted.begin(), sorted.end());
+        }
+    }, 2);
+
+    bench::Report(context, "ObjectIndex::Find", name, findNs, mismatches, 0, "wrong");
+    bench::ReportTime("ObjectIndex::Find", name, missNs, "missing id");
+    bench::ReportTime("ObjectIndex::Insert", name, insertNs);
+    bench::ReportTime("ObjectIndex::Remove", name, removeNs, "with insert");
+    bench::ReportTime("std::lower_bound", name, binaryNs, "old pin and link lookup");
+    bench::ReportTime("linear scan", name, linearNs, "old node lookup");
+    bench::ReportTime("push_back + std::sort", name, sortNs, "old pin and link insert");
+}
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+void RunObjectIndexTests(bench::Context& context)
+{
+    bench::PrintHeader("Object index");
+
+    TestObjectIndex(context, 1000, false, "1k seq");
+    TestObjectIndex(context, 1000, true,  "1k ptr");
+    TestObjectIndex(context, 10000, false, "10k seq");
+    TestObjectIndex(context, 10000, true,  "10k ptr");
+
+    if (context.Quick)
+        return;
+
+    TestObjectIndex(context, 100000, false, "100k seq");
+    TestObjectIndex(context, 100000, true,  "100k ptr");
+}
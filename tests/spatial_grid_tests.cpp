@@ -0,0 +1,214 @@
+//------------------------------------------------------------------------------
+// LICENSE
+//   This software is dual-licensed to the public domain and under the following
+//   license: you are granted a perpetual, irrevocable license to copy, modify,
+//   publish, and distribute this file as you see fit.
+//------------------------------------------------------------------------------
+// Spatial queries over node bounds.
+//
+// SpatialGrid is used the way FindNodeAt() and FindNodesInRect() use it and
+// answers are compared with linear scan of all nodes, which is what editor
+// did before. Canvas grows with node count, so density stays the same. Every
+// thousandth node is a large group spanning too many cells for the fine level.
+//------------------------------------------------------------------------------
+# include "bench.h"
+# include <imgui_node_editor_internal.h>
+
+
+//------------------------------------------------------------------------------
+namespace {
+
+namespace ed = ax::NodeEditor::Detail;
+
+struct Box
+{
+    ImRect               m_Bounds;
+    int                  m_Order;
+    ed::SpatialGridEntry m_GridEntry;
+};
+
+using Grid = ed::SpatialGrid<Box>;
+
+ImRect RandomBox(bench::Random& random, float extent, bool isGroup)
+{
+    const auto size = isGroup
+        ? ImVec2(random.Float(1000.0f, 3000.0f), random.Float(1000.0f, 3000.0f))
+        : ImVec2(random.Float(100.0f, 300.0f), random.Float(50.0f, 200.0f));
+    const auto min  = ImVec2(random.Float(0.0f, extent), random.Float(0.0f, extent));
+    return ImRect(min, min + size);
+}
+
+// Same as FindNodeAt(), node which comes first wins.
+Box* FindAt(const Grid& grid, const ImVec2& p, std::vector<Box*>& query)
+{
+    query.resize(0);
+    grid.Query(p, query);
+
+    Box* result = nullptr;
+    for (auto box : query)
+        if ((!result || box->m_Order < result->m_Order) && box->m_Bounds.Contains(p))
+            result = box;
+
+    return result;
+}
+
+Box* FindAtLinear(std::vector<Box>& boxes, const ImVec2& p)
+{
+    for (auto& box : boxes)
+        if (box.m_Bounds.Contains(p))
+            return &box;
+
+    return nullptr;
+}
+
+// Same as FindNodesInRect() with intersecting nodes included.
+void FindInRect(const Grid& grid, const ImRect& r, std::vector<Box*>& result)
+{
+    result.resize(0);
+    grid.Query(r, result);
+
+    result.erase(std::remove_if(result.begin(), result.end(), [&r](Box* box) { return !box->m_Bounds.Overlaps(r); }), result.end());
+    std::sort(result.begin(), result.end(), [](const Box* lhs, const Box* rhs) { return lhs->m_Order < rhs->m_Order; });
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+void FindInRectLinear(std::vector<Box>& boxes, const ImRect& r, std::vector<Box*>& result)
+{
+    result.resize(0);
+    for (auto& box : boxes)
+        if (box.m_Bounds.Overlaps(r))
+            result.push_back(&box);
+}
+
+void TestSpatialGrid(bench::Context& context, int count, const char* name)
+{
+    bench::Random random(static_cast<uint32_t>(count));
+
+    // About 40 nodes on 1920x1080 screen at zoom 1
+    const auto extent = ImSqrt(static_cast<float>(count)) * 230.0f;
+
+    std::vector<Box> boxes(count);
+    for (int i = 0; i < count; ++i)
+    {
+        boxes[i].m_Bounds = RandomBox(random, extent, i % 1000 == 999);
+        boxes[i].m_Order  = i;
+    }
+
+    const int queryCount = 4096;
+    std::vector<ImVec2> points(queryCount);
+    std::vector<ImRect> rects(queryCount);
+    for (int i = 0; i < queryCount; ++i)
+    {
+        points[i] = ImVec2(random.Float(0.0f, extent), random.Float(0.0f, extent));
+        rects[i]  = ImRect(points[i], points[i] + ImVec2(1920.0f, 1080.0f));
+    }
+
+    Grid grid;
+    const auto buildNs = bench::MeasureNs(count, [&]
+    {
+        grid.Clear();
+        for (auto& box : boxes)
+        {
+            box.m_GridEntry = ed::SpatialGridEntry();
+            grid.Update(&box, box.m_Bounds);
+        }
+    }, 2);
+
+    // Every node is dragged a bit, some cross into neighbouring cells
+    std::vector<ImVec2> deltas(count);
+    for (auto& delta : deltas)
+        delta = ImVec2(random.Float(-32.0f, 32.0f), random.Float(-32.0f, 32.0f));
+
+    int moves = 0;
+    const auto moveNs = bench::MeasureNs(count, [&]
+    {
+        const auto sign = (moves++ & 1) ? -1.0f : 1.0f;
+        for (int i = 0; i < count; ++i)
+        {
+            boxes[i].m_Bounds.Translate(deltas[i] * sign);
+            grid.Update(&boxes[i], boxes[i].m_Bounds);
+        }
+    }, 4);
+
+    // Answers have to be the same as of linear scan
+    std::vector<Box*> query, result, expected;
+
+    const int checkCount = 512;
+
+    int mismatches = 0;
+    for (int i = 0; i < checkCount; ++i)
+    {
+        if (FindAt(grid, points[i], query) != FindAtLinear(boxes, points[i]))
+            ++mismatches;
+
+        FindInRect(grid, rects[i], result);
+        FindInRectLinear(boxes, rects[i], expected);
+        if (result != expected)
+            ++mismatches;
+    }
+
+    const auto pointNs = bench::MeasureNs(queryCount, [&]
+    {
+        int found = 0;
+        for (auto& point : points)
+            found += FindAt(grid, point, query) ? 1 : 0;
+        bench::DoNotOptimize(static_cast<float>(found));
+    });
+
+    const auto rectNs = bench::MeasureNs(queryCount, [&]
+    {
+        size_t found = 0;
+        for (auto& rect : rects)
+        {
+            FindInRect(grid, rect, result);
+            found += result.size();
+        }
+        bench::DoNotOptimize(static_cast<float>(found));
+    });
+
+    // Linear scans are slow, few queries are enough
+    const int linearCount = 64;
+
+    const auto linearPointNs = bench::MeasureNs(linearCount, [&]
+    {
+        int found = 0;
+        for (int i = 0; i < linearCount; ++i)
+            found += FindAtLinear(boxes, points[i]) ? 1 : 0;
+        bench::DoNotOptimize(static_cast<float>(found));
+    });
+
+    const auto linearRectNs = bench::MeasureNs(linearCount, [&]
+    {
+        size_t found = 0;
+        for (int i = 0; i < linearCount; ++i)
+        {
+            FindInRectLinear(boxes, rects[i], expected);
+            found += expected.size();
+        }
+        bench::DoNotOptimize(static_cast<float>(found));
+    });
+
+    bench::Report(context, "SpatialGrid point query", name, pointNs, mismatches, 0, "wrong");
+    bench::ReportTime("SpatialGrid rect query", name, rectNs, "1920x1080 rect");
+    bench::ReportTime("SpatialGrid::Update", name, buildNs, "register");
+    bench::ReportTime("SpatialGrid::Update", name, moveNs, "move by up to 32");
+    bench::ReportTime("linear point query", name, linearPointNs, "old FindNodeAt");
+    bench::ReportTime("linear rect query", name, linearRectNs, "old FindNodesInRect");
+}
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+void RunSpatialGridTests(bench::Context& context)
+{
+    bench::PrintHeader("Spatial grid");
+
+    TestSpatialGrid(context, 10000, "10k nodes");
+
+    if (context.Quick)
+        return;
+
+    TestSpatialGrid(context, 100000, "100k nodes");
+    TestSpatialGrid(context, 500000, "500k nodes");
+}
@@ -0,0 +1,141 @@
+//------------------------------------------------------------------------------
+// LICENSE
+//   This software is dual-licensed to the public domain and under the following
+//   license: you are granted a perpetual, irrevocable license to copy, modify,
+//   publish, and distribute this file as you see fit.
+//------------------------------------------------------------------------------
+// Canvas vertex and clip rectangle transform.
+//
+// ImGuiEx::TransformVertices() and ImGuiEx::TransformClipRects() are compared
+// with scalar loops canvas used before. Results have to be exactly the same.
+// Vertex counts go past cache sizes, where transform is bound by memory.
+//------------------------------------------------------------------------------
+# include "bench.h"
+# include <imgui_canvas.h>
+# include <cstring>
+# include <vector>
+
+
+//------------------------------------------------------------------------------
+namespace {
+
+const ImVec2 c_PreOffset  = ImVec2(-123.25f, 77.5f);
+const float  c_Scale      = 0.37f;
+const ImVec2 c_PostOffset = ImVec2(640.0f, -360.5f);
+
+void TransformVerticesScalar(ImDrawVert* begin, ImDrawVert* end)
+{
+    for (auto vertex = begin; vertex < end; ++vertex)
+    {
+        vertex->pos.x = (vertex->pos.x + c_PreOffset.x) * c_Scale + c_PostOffset.x;
+        vertex->pos.y = (vertex->pos.y + c_PreOffset.y) * c_Scale + c_PostOffset.y;
+    }
+}
+
+void TransformClipRectsScalar(ImDrawCmd* begin, ImDrawCmd* end)
+{
+    for (auto command = begin; command < end; ++command)
+    {
+        auto& clipRect = command->ClipRect;
+        clipRect.x = (clipRect.x + c_PreOffset.x) * c_Scale + c_PostOffset.x;
+        clipRect.y = (clipRect.y + c_PreOffset.y) * c_Scale + c_PostOffset.y;
+        clipRect.z = (clipRect.z + c_PreOffset.x) * c_Scale + c_PostOffset.x;
+        clipRect.w = (clipRect.w + c_PreOffset.y) * c_Scale + c_PostOffset.y;
+    }
+}
+
+void TestTransformVertices(bench::Context& context, int count, const char* name)
+{
+    bench::Random random(static_cast<uint32_t>(count));
+
+    // Odd count leaves tail for scalar code
+    count |= 1;
+
+    std::vector<ImDrawVert> source(count);
+    for (auto& vertex : source)
+    {
+        vertex.pos = ImVec2(random.Float(-5000.0f, 5000.0f), random.Float(-5000.0f, 5000.0f));
+        vertex.uv  = ImVec2(random.Float(0.0f, 1.0f), random.Float(0.0f, 1.0f));
+        vertex.col = random.Next();
+    }
+
+    auto vertices = source;
+    auto expected = source;
+    ImGuiEx::TransformVertices(vertices.data(), vertices.data() + count, c_PreOffset, c_Scale, c_PostOffset);
+    TransformVerticesScalar(expected.data(), expected.data() + count);
+
+    // Whole vertex is compared, uv and color have to stay untouched
+    int mismatches = 0;
+    for (int i = 0; i < count; ++i)
+        if (memcmp(&vertices[i], &expected[i], sizeof(ImDrawVert)) != 0)
+            ++mismatches;
+
+    // Transform is applied over and over, values stay bounded with scale below one
+    const auto kernelNs = bench::MeasureNs(count, [&]
+    {
+        ImGuiEx::TransformVertices(vertices.data(), vertices.data() + count, c_PreOffset, c_Scale, c_PostOffset);
+    });
+
+    const auto scalarNs = bench::MeasureNs(count, [&]
+    {
+        TransformVerticesScalar(expected.data(), expected.data() + count);
+    });
+
+    bench::Report(context, "ImGuiEx::TransformVertices", name, kernelNs, mismatches, 0, "wrong");
+    bench::ReportTime("scalar loop", name, scalarNs, "old canvas transform");
+}
+
+void TestTransformClipRects(bench::Context& context, int count, const char* name)
+{
+    bench::Random random(static_cast<uint32_t>(count) + 1);
+
+    std::vector<ImDrawCmd> commands(count);
+    for (auto& command : commands)
+    {
+        const auto min = ImVec2(random.Float(-5000.0f, 5000.0f), random.Float(-5000.0f, 5000.0f));
+        command.ClipRect  = ImVec4(min.x, min.y, min.x + random.Float(0.0f, 2000.0f), min.y + random.Float(0.0f, 2000.0f));
+        command.ElemCount = random.Next();
+    }
+
+    auto expected = commands;
+    ImGuiEx::TransformClipRects(commands.data(), commands.data() + count, c_PreOffset, c_Scale, c_PostOffset);
+    TransformClipRectsScalar(expected.data(), expected.data() + count);
+
+    int mismatches = 0;
+    for (int i = 0; i < count; ++i)
+        if (memcmp(&commands[i].ClipRect, &expected[i].ClipRect, sizeof(ImVec4)) != 0 || commands[i].ElemCount != expected[i].ElemCount)
+            ++mismatches;
+
+    const auto kernelNs = bench::MeasureNs(count, [&]
+    {
+        ImGuiEx::TransformClipRects(commands.data(), commands.data() + count, c_PreOffset, c_Scale, c_PostOffset);
+    });
+
+    const auto scalarNs = bench::MeasureNs(count, [&]
+    {
+        TransformClipRectsScalar(expected.data(), expected.data() + count);
+    });
+
+    bench::Report(context, "ImGuiEx::TransformClipRects", name, kernelNs, mismatches, 0, "wrong");
+    bench::ReportTime("scalar loop", name, scalarNs, "old canvas transform");
+}
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+void RunTransformTests(bench::Context& context)
+{
+    bench::PrintHeader("Canvas transform");
+
+    TestTransformVertices(context, 64 * 1024, "64k");
+    TestTransformClipRects(context, 4 * 1024, "4k");
+
+    if (context.Quick)
+        return;
+
+    TestTransformVertices(context, 1024 * 1024, "1M");
+    TestTransformVertices(context, 4 * 1024 * 1024, "4M");
+    TestTransformVertices(context, 16 * 1024 * 1024, "16M");
+    TestTransformClipRects(context, 64 * 1024, "64k");
+}